@@ -0,0 +1,722 @@
+#ifndef ART_H
+#define ART_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+using namespace std;
+
+// Node16 compares its 16 key bytes with one SSE2 instruction where the compiler targets it
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ART_HAS_SSE2 1
+#else
+#define ART_HAS_SSE2 0
+#endif
+
+const int ART_KEY_BYTES = 4; // an id is stored as four key bytes, most significant first
+
+// Node types, the inner ones are named after the most children they hold
+enum ARTNodeType : uint8_t
+{
+    ART_LEAF,
+    ART_NODE4,
+    ART_NODE16,
+    ART_NODE48,
+    ART_NODE256
+};
+
+// Header shared by every node of an Adaptive Radix Tree
+struct ARTNode
+{
+    uint8_t type;                      // one of ARTNodeType
+    uint8_t prefixLength;              // key bytes skipped by path compression
+    uint16_t count;                    // number of children
+    uint8_t prefix[ART_KEY_BYTES - 1]; // the skipped bytes, an inner node always branches on at least one byte of its own
+
+    ARTNode(uint8_t type)
+        : type(type), prefixLength(0), count(0) {}
+};
+
+// Leaf holding one record and its whole key, hung directly below the first inner node where its key is unique
+struct ARTLeaf : ARTNode
+{
+    uint32_t key; // id with the sign bit flipped, so comparing keys as unsigned numbers orders them like the ids
+    int id;
+    string name;
+    int age;
+
+    ARTLeaf(uint32_t key, int id, string_view name, int age)
+        : ARTNode(ART_LEAF), key(key), id(id), name(name), age(age) {}
+};
+
+// Up to 4 children, keys sorted
+struct ARTNode4 : ARTNode
+{
+    uint8_t keys[4];
+    ARTNode *children[4];
+
+    ARTNode4() : ARTNode(ART_NODE4) {}
+};
+
+// Up to 16 children, keys sorted
+struct ARTNode16 : ARTNode
+{
+    uint8_t keys[16];
+    ARTNode *children[16];
+
+    ARTNode16() : ARTNode(ART_NODE16) {}
+};
+
+// Up to 48 children, a key byte is mapped to its child through a 256-entry index
+struct ARTNode48 : ARTNode
+{
+    uint8_t childIndex[256]; // slot of the child plus one, 0 if the byte has no child
+    ARTNode *children[48];   // free slots are null
+
+    ARTNode48() : ARTNode(ART_NODE48)
+    {
+        memset(childIndex, 0, sizeof(childIndex));
+        memset(children, 0, sizeof(children));
+    }
+};
+
+// Up to 256 children, indexed directly by the key byte
+struct ARTNode256 : ARTNode
+{
+    ARTNode *children[256];
+
+    ARTNode256() : ARTNode(ART_NODE256)
+    {
+        memset(children, 0, sizeof(children));
+    }
+};
+
+// Adaptive Radix Tree Class
+// Ids are split into bytes and every inner node branches on one of them, so a search costs at most
+// ART_KEY_BYTES steps whatever the number of records, and no step compares whole keys.
+// Each inner node uses the smallest of the four layouts that fits its children and grows or shrinks as they
+// change. Bytes shared by every key below a node are stored in the node instead of a chain of one-child nodes.
+class ART
+{
+private:
+    ARTNode *root;
+    int records; // Number of records stored
+
+    // key bytes of an id, most significant first, with the sign bit flipped so negative ids come first
+    static uint32_t toKey(int id)
+    {
+        return (uint32_t)id ^ 0x80000000u;
+    }
+
+    static uint8_t keyByte(uint32_t key, int depth)
+    {
+        return key >> (8 * (ART_KEY_BYTES - 1 - depth));
+    }
+
+    // prefix and child count move along when a node is replaced by another layout
+    static void copyHeader(ARTNode *to, const ARTNode *from)
+    {
+        to->prefixLength = from->prefixLength;
+        to->count = from->count;
+        memcpy(to->prefix, from->prefix, sizeof(from->prefix));
+    }
+
+    void destroy(ARTNode *node);
+    ARTNode **findChild(ARTNode *node, uint8_t byte);
+    int prefixMismatch(ARTNode *node, uint32_t key, int depth);
+    void addChild(ARTNode *&ref, uint8_t byte, ARTNode *child);
+    void removeChild(ARTNode *&ref, uint8_t byte);
+    bool insert(ARTNode *&ref, uint32_t key, int depth, int id, string_view name, int age);
+    bool remove(ARTNode *&ref, uint32_t key, int depth);
+
+    template <typename Visit>
+    void forRange(ARTNode *node, uint32_t path, int depth, uint32_t lo, uint32_t hi, Visit &visit);
+
+public:
+    ART()
+    {
+        root = nullptr;
+        records = 0;
+    }
+
+    // The tree owns its nodes and leaves, a copy would free them a second time
+    ART(const ART &) = delete;
+    ART &operator=(const ART &) = delete;
+
+    ~ART()
+    {
+        destroy(root);
+    }
+
+    void insert(int id, string_view name, int age)
+    {
+        if (insert(root, toKey(id), 0, id, name, age))
+        {
+            records++;
+        }
+    }
+
+    void remove(int id)
+    {
+        if (remove(root, toKey(id), 0))
+        {
+            records--;
+        }
+    }
+
+    bool search(int id)
+    {
+        return find(id) != nullptr;
+    }
+
+    ARTLeaf *find(int id);
+
+    int size()
+    {
+        return records;
+    }
+
+    // call visit on the leaf of every id in [lo, hi] in increasing order
+    template <typename Visit>
+    void forRange(int lo, int hi, Visit visit)
+    {
+        if (lo <= hi)
+        {
+            forRange(root, 0, 0, toKey(lo), toKey(hi), visit);
+        }
+    }
+};
+
+// Free a node and every node below it, through its real type since the nodes have no virtual destructor
+void ART::destroy(ARTNode *node)
+{
+    if (!node)
+    {
+        return;
+    }
+    switch (node->type)
+    {
+    case ART_LEAF:
+        delete static_cast<ARTLeaf *>(node);
+        break;
+    case ART_NODE4:
+    {
+        ARTNode4 *inner = static_cast<ARTNode4 *>(node);
+        for (int i = 0; i < inner->count; i++)
+        {
+            destroy(inner->children[i]);
+        }
+        delete inner;
+        break;
+    }
+    case ART_NODE16:
+    {
+        ARTNode16 *inner = static_cast<ARTNode16 *>(node);
+        for (int i = 0; i < inner->count; i++)
+        {
+            destroy(inner->children[i]);
+        }
+        delete inner;
+        break;
+    }
+    case ART_NODE48:
+    {
+        ARTNode48 *inner = static_cast<ARTNode48 *>(node);
+        for (ARTNode *child : inner->children)
+        {
+            destroy(child);
+        }
+        delete inner;
+        break;
+    }
+    case ART_NODE256:
+    {
+        ARTNode256 *inner = static_cast<ARTNode256 *>(node);
+        for (ARTNode *child : inner->children)
+        {
+            destroy(child);
+        }
+        delete inner;
+        break;
+    }
+    }
+}
+
+// Slot of the child for a key byte, nullptr if the node has none
+ARTNode **ART::findChild(ARTNode *node, uint8_t byte)
+{
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ARTNode4 *inner = static_cast<ARTNode4 *>(node);
+        for (int i = 0; i < inner->count; i++)
+        {
+            if (inner->keys[i] == byte)
+            {
+                return &inner->children[i];
+            }
+        }
+        return nullptr;
+    }
+    case ART_NODE16:
+    {
+        ARTNode16 *inner = static_cast<ARTNode16 *>(node);
+#if ART_HAS_SSE2
+        __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(byte), _mm_loadu_si128((const __m128i *)inner->keys));
+        int mask = _mm_movemask_epi8(matches) & ((1 << inner->count) - 1); // slots past count hold stale bytes
+        return mask ? &inner->children[__builtin_ctz(mask)] : nullptr;
+#else
+        for (int i = 0; i < inner->count; i++)
+        {
+            if (inner->keys[i] == byte)
+            {
+                return &inner->children[i];
+            }
+        }
+        return nullptr;
+#endif
+    }
+    case ART_NODE48:
+    {
+        ARTNode48 *inner = static_cast<ARTNode48 *>(node);
+        int slot = inner->childIndex[byte];
+        return slot ? &inner->children[slot - 1] : nullptr;
+    }
+    case ART_NODE256:
+    {
+        ARTNode256 *inner = static_cast<ARTNode256 *>(node);
+        return inner->children[byte] ? &inner->children[byte] : nullptr;
+    }
+    }
+    return nullptr;
+}
+
+// Number of prefix bytes of a node that the key matches, starting at the given depth
+int ART::prefixMismatch(ARTNode *node, uint32_t key, int depth)
+{
+    int i = 0;
+    while (i < node->prefixLength && node->prefix[i] == keyByte(key, depth + i))
+    {
+        i++;
+    }
+    return i;
+}
+
+// Add a child under a new key byte, replacing the node by the next larger layout when it is full
+void ART::addChild(ARTNode *&ref, uint8_t byte, ARTNode *child)
+{
+    ARTNode *node = ref;
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ARTNode4 *inner = static_cast<ARTNode4 *>(node);
+        if (inner->count < 4)
+        {
+            int i = inner->count;
+            while (i > 0 && inner->keys[i - 1] > byte)
+            {
+                inner->keys[i] = inner->keys[i - 1]; // keep the keys sorted
+                inner->children[i] = inner->children[i - 1];
+                i--;
+            }
+            inner->keys[i] = byte;
+            inner->children[i] = child;
+            inner->count++;
+            return;
+        }
+        ARTNode16 *grown = new ARTNode16();
+        copyHeader(grown, inner);
+        memcpy(grown->keys, inner->keys, sizeof(inner->keys));
+        memcpy(grown->children, inner->children, sizeof(inner->children));
+        delete inner;
+        ref = grown;
+        break;
+    }
+    case ART_NODE16:
+    {
+        ARTNode16 *inner = static_cast<ARTNode16 *>(node);
+        if (inner->count < 16)
+        {
+            int i = inner->count;
+            while (i > 0 && inner->keys[i - 1] > byte)
+            {
+                inner->keys[i] = inner->keys[i - 1]; // keep the keys sorted
+                inner->children[i] = inner->children[i - 1];
+                i--;
+            }
+            inner->keys[i] = byte;
+            inner->children[i] = child;
+            inner->count++;
+            return;
+        }
+        ARTNode48 *grown = new ARTNode48();
+        copyHeader(grown, inner);
+        for (int i = 0; i < 16; i++)
+        {
+            grown->childIndex[inner->keys[i]] = i + 1;
+            grown->children[i] = inner->children[i];
+        }
+        delete inner;
+        ref = grown;
+        break;
+    }
+    case ART_NODE48:
+    {
+        ARTNode48 *inner = static_cast<ARTNode48 *>(node);
+        if (inner->count < 48)
+        {
+            int slot = 0;
+            while (inner->children[slot])
+            {
+                slot++; // slots freed by removes are reused
+            }
+            inner->children[slot] = child;
+            inner->childIndex[byte] = slot + 1;
+            inner->count++;
+            return;
+        }
+        ARTNode256 *grown = new ARTNode256();
+        copyHeader(grown, inner);
+        for (int b = 0; b < 256; b++)
+        {
+            if (inner->childIndex[b])
+            {
+                grown->children[b] = inner->children[inner->childIndex[b] - 1];
+            }
+        }
+        delete inner;
+        ref = grown;
+        break;
+    }
+    case ART_NODE256:
+    {
+        ARTNode256 *inner = static_cast<ARTNode256 *>(node);
+        inner->children[byte] = child;
+        inner->count++;
+        return;
+    }
+    }
+    addChild(ref, byte, child); // the grown node has room
+}
+
+// Remove the child under a key byte, replacing the node by the next smaller layout when it gets sparse
+// A Node4 left with one child is replaced by that child, its prefix is moved down into the child
+void ART::removeChild(ARTNode *&ref, uint8_t byte)
+{
+    ARTNode *node = ref;
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ARTNode4 *inner = static_cast<ARTNode4 *>(node);
+        int i = 0;
+        while (inner->keys[i] != byte)
+        {
+            i++;
+        }
+        for (; i + 1 < inner->count; i++)
+        {
+            inner->keys[i] = inner->keys[i + 1];
+            inner->children[i] = inner->children[i + 1];
+        }
+        inner->count--;
+        if (inner->count == 1)
+        {
+            ARTNode *child = inner->children[0];
+            if (child->type != ART_LEAF)
+            {
+                // the child's bytes are now this node's prefix, its own key byte and its old prefix
+                uint8_t prefix[ART_KEY_BYTES - 1];
+                int length = inner->prefixLength;
+                memcpy(prefix, inner->prefix, length);
+                prefix[length++] = inner->keys[0];
+                memcpy(prefix + length, child->prefix, child->prefixLength);
+                length += child->prefixLength;
+                memcpy(child->prefix, prefix, length);
+                child->prefixLength = length;
+            }
+            delete inner;
+            ref = child;
+        }
+        break;
+    }
+    case ART_NODE16:
+    {
+        ARTNode16 *inner = static_cast<ARTNode16 *>(node);
+        int i = 0;
+        while (inner->keys[i] != byte)
+        {
+            i++;
+        }
+        for (; i + 1 < inner->count; i++)
+        {
+            inner->keys[i] = inner->keys[i + 1];
+            inner->children[i] = inner->children[i + 1];
+        }
+        inner->count--;
+        if (inner->count == 3)
+        {
+            ARTNode4 *shrunk = new ARTNode4();
+            copyHeader(shrunk, inner);
+            memcpy(shrunk->keys, inner->keys, 3);
+            memcpy(shrunk->children, inner->children, 3 * sizeof(ARTNode *));
+            delete inner;
+            ref = shrunk;
+        }
+        break;
+    }
+    case ART_NODE48:
+    {
+        ARTNode48 *inner = static_cast<ARTNode48 *>(node);
+        inner->children[inner->childIndex[byte] - 1] = nullptr;
+        inner->childIndex[byte] = 0;
+        inner->count--;
+        if (inner->count == 12)
+        {
+            ARTNode16 *shrunk = new ARTNode16();
+            copyHeader(shrunk, inner);
+            int i = 0;
+            for (int b = 0; b < 256; b++)
+            {
+                if (inner->childIndex[b])
+                {
+                    shrunk->keys[i] = b; // bytes are visited in order, so the keys come out sorted
+                    shrunk->children[i++] = inner->children[inner->childIndex[b] - 1];
+                }
+            }
+            delete inner;
+            ref = shrunk;
+        }
+        break;
+    }
+    case ART_NODE256:
+    {
+        ARTNode256 *inner = static_cast<ARTNode256 *>(node);
+        inner->children[byte] = nullptr;
+        inner->count--;
+        if (inner->count == 37)
+        {
+            // shrinking well below 48 keeps a node that hovers around the limit from growing and shrinking on every update
+            ARTNode48 *shrunk = new ARTNode48();
+            copyHeader(shrunk, inner);
+            int slot = 0;
+            for (int b = 0; b < 256; b++)
+            {
+                if (inner->children[b])
+                {
+                    shrunk->children[slot] = inner->children[b];
+                    shrunk->childIndex[b] = ++slot;
+                }
+            }
+            delete inner;
+            ref = shrunk;
+        }
+        break;
+    }
+    }
+}
+
+// Insert a record below ref, whose node starts at key byte depth; returns false for a duplicate id
+bool ART::insert(ARTNode *&ref, uint32_t key, int depth, int id, string_view name, int age)
+{
+    ARTNode *node = ref;
+    if (!node)
+    {
+        ref = new ARTLeaf(key, id, name, age);
+        return true;
+    }
+
+    if (node->type == ART_LEAF)
+    {
+        ARTLeaf *leaf = static_cast<ARTLeaf *>(node);
+        if (leaf->key == key)
+        {
+            return false; // Duplicate IDs not allowed
+        }
+        // the two keys part here: the bytes they share become the prefix of a new Node4 holding both leaves
+        ARTNode4 *inner = new ARTNode4();
+        int length = 0;
+        while (keyByte(leaf->key, depth + length) == keyByte(key, depth + length))
+        {
+            inner->prefix[length] = keyByte(key, depth + length);
+            length++;
+        }
+        inner->prefixLength = length;
+        ref = inner;
+        addChild(ref, keyByte(leaf->key, depth + length), leaf);
+        addChild(ref, keyByte(key, depth + length), new ARTLeaf(key, id, name, age));
+        return true;
+    }
+
+    int matched = prefixMismatch(node, key, depth);
+    if (matched < node->prefixLength)
+    {
+        // the key leaves the prefix part way: a new Node4 takes the matched part, the node keeps the rest
+        ARTNode4 *inner = new ARTNode4();
+        inner->prefixLength = matched;
+        memcpy(inner->prefix, node->prefix, matched);
+        uint8_t nodeByte = node->prefix[matched];
+        node->prefixLength -= matched + 1;
+        memmove(node->prefix, node->prefix + matched + 1, node->prefixLength);
+        ref = inner;
+        addChild(ref, nodeByte, node);
+        addChild(ref, keyByte(key, depth + matched), new ARTLeaf(key, id, name, age));
+        return true;
+    }
+
+    depth += node->prefixLength;
+    ARTNode **child = findChild(node, keyByte(key, depth));
+    if (child)
+    {
+        return insert(*child, key, depth + 1, id, name, age);
+    }
+    addChild(ref, keyByte(key, depth), new ARTLeaf(key, id, name, age));
+    return true;
+}
+
+// Remove the record with the given key below ref; returns false if it is not in the tree
+bool ART::remove(ARTNode *&ref, uint32_t key, int depth)
+{
+    ARTNode *node = ref;
+    if (!node)
+    {
+        return false;
+    }
+    if (node->type == ART_LEAF)
+    {
+        // only reached when the whole tree is one leaf, other leaves are removed by their parent
+        if (static_cast<ARTLeaf *>(node)->key != key)
+        {
+            return false;
+        }
+        delete static_cast<ARTLeaf *>(node);
+        ref = nullptr;
+        return true;
+    }
+
+    if (prefixMismatch(node, key, depth) < node->prefixLength)
+    {
+        return false;
+    }
+    depth += node->prefixLength;
+    uint8_t byte = keyByte(key, depth);
+    ARTNode **child = findChild(node, byte);
+    if (!child)
+    {
+        return false;
+    }
+    if ((*child)->type == ART_LEAF)
+    {
+        ARTLeaf *leaf = static_cast<ARTLeaf *>(*child);
+        if (leaf->key != key)
+        {
+            return false;
+        }
+        delete leaf;
+        removeChild(ref, byte);
+        return true;
+    }
+    return remove(*child, key, depth + 1);
+}
+
+// Search for an id
+// Prefixes are skipped without being compared, the leaf holds the whole key and is compared once at the end
+ARTLeaf *ART::find(int id)
+{
+    uint32_t key = toKey(id);
+    ARTNode *node = root;
+    int depth = 0;
+    while (node && node->type != ART_LEAF)
+    {
+        depth += node->prefixLength;
+        ARTNode **child = findChild(node, keyByte(key, depth));
+        node = child ? *child : nullptr;
+        depth++;
+    }
+    if (node && static_cast<ARTLeaf *>(node)->key == key)
+    {
+        return static_cast<ARTLeaf *>(node);
+    }
+    return nullptr;
+}
+
+// Visit the leaves in [lo, hi] below a node in key order
+// path holds the key bytes above depth, subtrees whose keys all fall outside the range are skipped
+template <typename Visit>
+void ART::forRange(ARTNode *node, uint32_t path, int depth, uint32_t lo, uint32_t hi, Visit &visit)
+{
+    if (!node)
+    {
+        return;
+    }
+    if (node->type == ART_LEAF)
+    {
+        ARTLeaf *leaf = static_cast<ARTLeaf *>(node);
+        if (leaf->key >= lo && leaf->key <= hi)
+        {
+            visit(leaf);
+        }
+        return;
+    }
+
+    for (int i = 0; i < node->prefixLength; i++)
+    {
+        path |= (uint32_t)node->prefix[i] << (8 * (ART_KEY_BYTES - 1 - depth - i));
+    }
+    depth += node->prefixLength;
+    int shift = 8 * (ART_KEY_BYTES - 1 - depth);            // position of the byte this node branches on
+    uint32_t below = (uint32_t)((1ull << (shift + 8)) - 1); // the bytes from this one down are still open
+    if ((path | below) < lo || path > hi)
+    {
+        return;
+    }
+
+    switch (node->type)
+    {
+    case ART_NODE4:
+    {
+        ARTNode4 *inner = static_cast<ARTNode4 *>(node);
+        for (int i = 0; i < inner->count; i++)
+        {
+            forRange(inner->children[i], path | (uint32_t)inner->keys[i] << shift, depth + 1, lo, hi, visit);
+        }
+        break;
+    }
+    case ART_NODE16:
+    {
+        ARTNode16 *inner = static_cast<ARTNode16 *>(node);
+        for (int i = 0; i < inner->count; i++)
+        {
+            forRange(inner->children[i], path | (uint32_t)inner->keys[i] << shift, depth + 1, lo, hi, visit);
+        }
+        break;
+    }
+    case ART_NODE48:
+    {
+        ARTNode48 *inner = static_cast<ARTNode48 *>(node);
+        for (int b = 0; b < 256; b++)
+        {
+            if (inner->childIndex[b])
+            {
+                forRange(inner->children[inner->childIndex[b] - 1], path | (uint32_t)b << shift, depth + 1, lo, hi, visit);
+            }
+        }
+        break;
+    }
+    case ART_NODE256:
+    {
+        ARTNode256 *inner = static_cast<ARTNode256 *>(node);
+        for (int b = 0; b < 256; b++)
+        {
+            forRange(inner->children[b], path | (uint32_t)b << shift, depth + 1, lo, hi, visit);
+        }
+        break;
+    }
+    }
+}
+
+#endif
@@ -1,85 +1,129 @@
 #ifndef AVL_H
 #define AVL_H
 
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "KeyRuns.h"
+#include "Parallel.h"
+#include "Record.h"
 using namespace std;
 
-// structure for Node containing data and pointers to left and right children in an AVL Tree
-struct AVLNode
+// name and age of a record, what a node of a record tree carries besides its key
+struct RecordFields
 {
-    int id;
     string name;
     int age;
+};
+
+// nothing besides the key, for a tree that is an index into another one
+struct KeyOnly
+{
+};
+
+// structure for Node containing data and pointers to left and right children in an AVL Tree
+// the payload comes first, so a record node has no padding between its fields
+template <typename Key, typename Payload>
+struct BasicAVLNode : Payload
+{
+    Key id;
     int height;
-    AVLNode *left;
-    AVLNode *right;
+    int size; // number of nodes in the subtree rooted here, used for rank and select
+    BasicAVLNode *left;
+    BasicAVLNode *right;
 
-    AVLNode(int id, string name, int age)
-        : id(id), name(name), age(age), height(1), left(nullptr), right(nullptr) {}
+    BasicAVLNode(Key id, Payload payload)
+        : Payload(move(payload)), id(id), height(1), size(1), left(nullptr), right(nullptr) {}
 };
 
-// AVL Tree
-class AVL
+using AVLNode = BasicAVLNode<int, RecordFields>;
+
+// AVL Tree, ordered by a key of type Key (the int id of a record unless told otherwise)
+// Key needs the comparison operators, e.g. a pair makes a composite key
+// Payload is what every node carries besides the key, a record unless the tree is an index
+// build, insertMany and eraseMany need int keys and records, a Record and a run of ids have no other
+template <typename Key = int, typename Payload = RecordFields>
+class BasicAVL
 {
 private:
-    AVLNode *root; // root node of the AVL Tree
+    using Node = BasicAVLNode<Key, Payload>;
 
-    int getHeight(AVLNode *node)
+    Node *root; // root node of the AVL Tree
+
+    // finger: the path from the root to the last node touched by a hinted call
+    // fingerLo[i]->id < id < fingerHi[i]->id for every id in the subtree of finger[i], a null bound is open
+    // any other change to the tree clears it, and the next hinted call starts again from the root
+    vector<Node *> finger;
+    vector<Node *> fingerLo;
+    vector<Node *> fingerHi;
+
+    int getHeight(Node *node)
     {
         return node ? node->height : 0; // if node is not null then return the height of the node otherwise return 0
     }
 
-    int getBalanceFactor(AVLNode *node)
+    int getSize(Node *node)
+    {
+        return node ? node->size : 0; // if node is not null then return the size of its subtree otherwise return 0
+    }
+
+    int getBalanceFactor(Node *node)
     {
         return node ? getHeight(node->left) - getHeight(node->right) : 0; // if node is not null then return the difference of height of left and right children of the node otherwise return 0
     }
 
-    AVLNode *rotateRight(AVLNode *y)
+    Node *rotateRight(Node *y)
     {
-        AVLNode *x = y->left;     // x is the left child of y
-        AVLNode *temp = x->right; // temp is the right child of x
+        Node *x = y->left;     // x is the left child of y
+        Node *temp = x->right; // temp is the right child of x
 
         x->right = y;   // make y the right child of x
         y->left = temp; // make temp the left child of y
 
         y->height = max(getHeight(y->left), getHeight(y->right)) + 1; // update the height of y
+        y->size = getSize(y->left) + getSize(y->right) + 1;           // update the size of y
         x->height = max(getHeight(x->left), getHeight(x->right)) + 1; // update the height of x
+        x->size = getSize(x->left) + getSize(x->right) + 1;           // update the size of x
 
         return x; // return the new root
     }
 
-    AVLNode *rotateLeft(AVLNode *x)
+    Node *rotateLeft(Node *x)
     {
-        AVLNode *y = x->right;   // y is the right child of x
-        AVLNode *temp = y->left; // temp is the left child of y
+        Node *y = x->right;   // y is the right child of x
+        Node *temp = y->left; // temp is the left child of y
 
         y->left = x;     // make x the left child of y
         x->right = temp; // make temp the right child of x
 
         x->height = max(getHeight(x->left), getHeight(x->right)) + 1; // update the height of x
+        x->size = getSize(x->left) + getSize(x->right) + 1;           // update the size of x
         y->height = max(getHeight(y->left), getHeight(y->right)) + 1; // update the height of x and y
+        y->size = getSize(y->left) + getSize(y->right) + 1;           // update the size of y
 
         return y; // return the new root
     }
 
-    AVLNode *insert(AVLNode *node, int id, string name, int age)
+    Node *insert(Node *node, Key id, Payload &payload)
     {
         if (!node)
         {
-            return new AVLNode(id, name, age); // if node is null then create a new node
+            return new Node(id, move(payload)); // if node is null then create a new node
         }
         if (id < node->id)
         {
-            node->left = insert(node->left, id, name, age); // if id is less than the id of the node then insert in the left subtree
+            node->left = insert(node->left, id, payload); // if id is less than the id of the node then insert in the left subtree
         }
         else if (id > node->id)
         {
-            node->right = insert(node->right, id, name, age); // if id is greater than the id of the node then insert in the right subtree
+            node->right = insert(node->right, id, payload); // if id is greater than the id of the node then insert in the right subtree
         }
         else
             return node; // Duplicate IDs not allowed
 
         node->height = max(getHeight(node->left), getHeight(node->right)) + 1; // update the height of the node
+        node->size = getSize(node->left) + getSize(node->right) + 1;           // update the size of the node
 
         int balance = getBalanceFactor(node); // get the balance factor of the node
 
@@ -112,9 +156,9 @@ private:
         return node; // return the node
     }
 
-    AVLNode *minValueNode(AVLNode *node)
+    Node *minValueNode(Node *node)
     {
-        AVLNode *current = node; // current is the node
+        Node *current = node; // current is the node
         while (current->left)
         {
             current = current->left; // traverse to the leftmost node
@@ -122,7 +166,7 @@ private:
         return current; // return the leftmost node
     }
 
-    AVLNode *deleteNode(AVLNode *root, int id)
+    Node *deleteNode(Node *root, Key id)
     {
         if (!root)
         {
@@ -141,7 +185,7 @@ private:
             // Node with only one child or no child
             if (!root->left || !root->right) // if root has no child or only one child
             {
-                AVLNode *temp = root->left ? root->left : root->right;
+                Node *temp = root->left ? root->left : root->right;
 
                 // if root has no child
                 if (!temp)
@@ -157,12 +201,11 @@ private:
             }
             else
             {
-                AVLNode *temp = minValueNode(root->right); // find the inorder successor of the root
+                Node *temp = minValueNode(root->right); // find the inorder successor of the root
 
                 // Copy the inorder successor's data to this node
                 root->id = temp->id;
-                root->name = temp->name;
-                root->age = temp->age;
+                (Payload &)*root = *temp;
 
                 root->right = deleteNode(root->right, temp->id); // delete the inorder successor
             }
@@ -173,6 +216,7 @@ private:
             return root; // if root is null then return root
         }
         root->height = max(getHeight(root->left), getHeight(root->right)) + 1; // update the height of the root
+        root->size = getSize(root->left) + getSize(root->right) + 1;           // update the size of the root
 
         int balance = getBalanceFactor(root); // get the balance factor of the root
 
@@ -201,7 +245,7 @@ private:
         return root;
     }
 
-    AVLNode *search(AVLNode *node, int id)
+    Node *search(Node *node, Key id)
     {
         if (!node || node->id == id)
         {
@@ -217,26 +261,685 @@ private:
         return search(node->right, id);
     }
 
+    // visit every node of the subtree in increasing order of id
+    template <typename Visit>
+    void forEach(Node *node, Visit &visit)
+    {
+        if (!node)
+        {
+            return;
+        }
+        forEach(node->left, visit);
+        visit(node);
+        forEach(node->right, visit);
+    }
+
+    // visit the nodes with lo <= id <= hi in increasing order of id, subtrees outside the range are skipped
+    template <typename Visit>
+    void forRange(Node *node, Key lo, Key hi, Visit &visit)
+    {
+        if (!node)
+        {
+            return;
+        }
+        if (lo < node->id)
+        {
+            forRange(node->left, lo, hi, visit);
+        }
+        if (!(node->id < lo) && !(hi < node->id))
+        {
+            visit(node);
+        }
+        if (node->id < hi)
+        {
+            forRange(node->right, lo, hi, visit);
+        }
+    }
+
+    // number of ids smaller than id, or smaller than or equal to id when inclusive is true
+    int rank(Node *node, Key id, bool inclusive)
+    {
+        int count = 0;
+        while (node)
+        {
+            if (id < node->id || (id == node->id && !inclusive))
+            {
+                node = node->left; // node and its right subtree are not counted
+            }
+            else
+            {
+                count += getSize(node->left) + 1; // node and its whole left subtree are counted
+                node = node->right;
+            }
+        }
+        return count;
+    }
+
+    void destroy(Node *node)
+    {
+        if (!node)
+        {
+            return;
+        }
+        destroy(node->left);  // free the left subtree
+        destroy(node->right); // free the right subtree
+        delete node;
+    }
+
+    Node *rebalance(Node *node)
+    {
+        node->height = max(getHeight(node->left), getHeight(node->right)) + 1; // update the height of the node
+        node->size = getSize(node->left) + getSize(node->right) + 1;           // update the size of the node
+
+        int balance = getBalanceFactor(node); // get the balance factor of the node
+
+        if (balance > 1)
+        {
+            if (getBalanceFactor(node->left) < 0)
+            {
+                node->left = rotateLeft(node->left); // Left-Right case
+            }
+            return rotateRight(node); // Left-Left case
+        }
+        if (balance < -1)
+        {
+            if (getBalanceFactor(node->right) > 0)
+            {
+                node->right = rotateRight(node->right); // Right-Left case
+            }
+            return rotateLeft(node); // Right-Right case
+        }
+        return node;
+    }
+
+    // join two trees with a middle node, every id in left < mid->id < every id in right
+    Node *join(Node *left, Node *mid, Node *right)
+    {
+        if (getHeight(left) > getHeight(right) + 1)
+        {
+            left->right = join(left->right, mid, right); // go down the right spine of the taller left tree
+            return rebalance(left);
+        }
+        if (getHeight(right) > getHeight(left) + 1)
+        {
+            right->left = join(left, mid, right->left); // go down the left spine of the taller right tree
+            return rebalance(right);
+        }
+        // heights are close enough, mid can be the root
+        mid->left = left;
+        mid->right = right;
+        mid->height = max(getHeight(left), getHeight(right)) + 1;
+        mid->size = getSize(left) + getSize(right) + 1; // update the size of mid
+        return mid;
+    }
+
+    // detach the node with the largest id, the rest of the tree is returned through rest
+    Node *splitLast(Node *node, Node *&rest)
+    {
+        if (!node->right)
+        {
+            rest = node->left; // node is the largest, its left subtree is what remains
+            return node;
+        }
+        Node *last = splitLast(node->right, rest);
+        rest = join(node->left, node, rest);
+        return last;
+    }
+
+    // join two trees without a middle node, every id in left < every id in right
+    Node *join(Node *left, Node *right)
+    {
+        if (!left)
+        {
+            return right;
+        }
+        Node *rest;
+        Node *last = splitLast(left, rest); // the largest node of left becomes the middle node
+        return join(rest, last, right);
+    }
+
+    // split the tree into ids < id (left) and ids > id (right), the node with the id itself is returned through match
+    void split(Node *node, Key id, Node *&left, Node *&match, Node *&right)
+    {
+        if (!node)
+        {
+            left = right = match = nullptr;
+            return;
+        }
+        if (id < node->id)
+        {
+            Node *rest;
+            split(node->left, id, left, match, rest);
+            right = join(rest, node, node->right); // node and its right subtree are all greater than id
+        }
+        else if (id > node->id)
+        {
+            Node *rest;
+            split(node->right, id, rest, match, right);
+            left = join(node->left, node, rest); // node and its left subtree are all smaller than id
+        }
+        else
+        {
+            left = node->left;
+            right = node->right;
+            match = node;
+            match->left = match->right = nullptr;
+            match->height = 1;
+            match->size = 1;
+        }
+    }
+
+    // every record of a and b, when an id is in both the record from a is kept
+    Node *unionOf(Node *a, Node *b, int threads)
+    {
+        if (!a)
+        {
+            return b;
+        }
+        if (!b)
+        {
+            return a;
+        }
+        Node *bLeft, *match, *bRight;
+        split(b, a->id, bLeft, match, bRight);
+        delete match; // the record from a wins
+
+        Node *aLeft = a->left, *aRight = a->right;
+        Node *left, *right;
+        forkJoin(
+            threads,
+            [&](int budget)
+            { left = unionOf(aLeft, bLeft, budget); },
+            [&](int budget)
+            { right = unionOf(aRight, bRight, budget); });
+
+        return join(left, a, right);
+    }
+
+    // records of a whose id is also in b, every other node is freed
+    Node *intersectionOf(Node *a, Node *b, int threads)
+    {
+        if (!a || !b)
+        {
+            destroy(a);
+            destroy(b);
+            return nullptr;
+        }
+        Node *bLeft, *match, *bRight;
+        split(b, a->id, bLeft, match, bRight);
+
+        Node *aLeft = a->left, *aRight = a->right;
+        Node *left, *right;
+        forkJoin(
+            threads,
+            [&](int budget)
+            { left = intersectionOf(aLeft, bLeft, budget); },
+            [&](int budget)
+            { right = intersectionOf(aRight, bRight, budget); });
+
+        if (match)
+        {
+            delete match;
+            return join(left, a, right); // the id is in both trees, keep the record from a
+        }
+        delete a;
+        return join(left, right);
+    }
+
+    // records of a whose id is not in b, every other node is freed and the number of records removed from a is added to erased
+    Node *differenceOf(Node *a, Node *b, int &erased, int threads)
+    {
+        if (!a || !b)
+        {
+            destroy(b);
+            return a;
+        }
+        Node *aLeft, *match, *aRight;
+        split(a, b->id, aLeft, match, aRight);
+
+        Node *bLeft = b->left, *bRight = b->right;
+        delete b;
+
+        Node *left, *right;
+        int leftErased = 0, rightErased = 0; // separate counters so the two halves never write the same int
+        forkJoin(
+            threads,
+            [&](int budget)
+            { left = differenceOf(aLeft, bLeft, leftErased, budget); },
+            [&](int budget)
+            { right = differenceOf(aRight, bRight, rightErased, budget); });
+
+        erased += leftErased + rightErased;
+        if (match)
+        {
+            delete match;
+            erased++;
+        }
+        return join(left, right);
+    }
+
+    // cut the ids in [lo, hi] out of the tree with two splits and free them whole
+    // the ids below lo are returned through left, the ids above hi through right
+    void eraseRange(Node *node, Key lo, Key hi, Node *&left, Node *&right, int &erased)
+    {
+        Node *loMatch, *rest, *inside, *hiMatch;
+        split(node, lo, left, loMatch, rest);
+        split(rest, hi, inside, hiMatch, right);
+        erased += getSize(inside) + (loMatch ? 1 : 0) + (hiMatch ? 1 : 0);
+        destroy(inside);
+        delete loMatch;
+        delete hiMatch;
+    }
+
+    // remove the ids in sortedIds[first, last), the number of records removed is added to erased
+    // the run in the middle is cut out as one range, the runs on either side are handled in parallel and joined back
+    Node *eraseMany(Node *node, const vector<int> &sortedIds, int first, int last, int &erased, int threads)
+    {
+        if (!node || first >= last)
+        {
+            return node;
+        }
+        int begin = runBegin(sortedIds, first + (last - first) / 2);
+        int end = runEnd(sortedIds, begin);
+
+        Node *left, *right;
+        eraseRange(node, sortedIds[begin], sortedIds[end - 1], left, right, erased);
+
+        int leftErased = 0, rightErased = 0; // separate counters so the two halves never write the same int
+        forkJoin(
+            threads,
+            [&](int budget)
+            { left = eraseMany(left, sortedIds, first, begin, leftErased, budget); },
+            [&](int budget)
+            { right = eraseMany(right, sortedIds, end, last, rightErased, budget); });
+
+        erased += leftErased + rightErased;
+        return join(left, right);
+    }
+
+    // build a perfectly balanced subtree from the sorted records in [lo, hi)
+    Node *build(vector<Record> &records, int lo, int hi, int threads)
+    {
+        if (lo >= hi)
+        {
+            return nullptr; // empty range gives an empty subtree
+        }
+        int mid = lo + (hi - lo) / 2; // the middle record becomes the root of this subtree
+        Node *node = new Node(records[mid].id, RecordFields{move(records[mid].name), records[mid].age});
+
+        // both halves are independent, so they can be built on different threads
+        forkJoin(
+            threads,
+            [&](int budget)
+            { node->left = build(records, lo, mid, budget); },
+            [&](int budget)
+            { node->right = build(records, mid + 1, hi, budget); });
+
+        node->height = max(getHeight(node->left), getHeight(node->right)) + 1; // stitch: the height follows from the two children
+        node->size = getSize(node->left) + getSize(node->right) + 1;           // update the size of the node
+        return node;
+    }
+
+    void pushFinger(Node *node, Node *lo, Node *hi)
+    {
+        finger.push_back(node);
+        fingerLo.push_back(lo);
+        fingerHi.push_back(hi);
+    }
+
+    void truncateFinger(int length)
+    {
+        finger.resize(length);
+        fingerLo.resize(length);
+        fingerHi.resize(length);
+    }
+
+    void clearFinger()
+    {
+        truncateFinger(0);
+    }
+
+    // whether the subtree of finger[depth] covers the id
+    bool holds(int depth, Key id)
+    {
+        return (!fingerLo[depth] || fingerLo[depth]->id < id) && (!fingerHi[depth] || id < fingerHi[depth]->id);
+    }
+
+    // move the finger to the node with the id, or to the node the id would be attached to
+    void seekFinger(Key id)
+    {
+        if (!root)
+        {
+            clearFinger();
+            return;
+        }
+        if (finger.empty())
+        {
+            pushFinger(root, nullptr, nullptr); // start again from the root
+        }
+        else
+        {
+            // climb until the subtree can hold the id, for nearby ids that is only a few steps
+            int depth = finger.size();
+            while (depth > 1 && !holds(depth - 1, id))
+            {
+                depth--;
+            }
+            truncateFinger(depth);
+        }
+
+        // then walk down from there as usual
+        Node *node = finger.back();
+        while (node->id != id)
+        {
+            Node *child = id < node->id ? node->left : node->right;
+            if (!child)
+            {
+                break;
+            }
+            if (id < node->id)
+            {
+                pushFinger(child, fingerLo.back(), node);
+            }
+            else
+            {
+                pushFinger(child, node, fingerHi.back());
+            }
+            node = child;
+        }
+    }
+
 public:
-    AVL() : root(nullptr) {}
+    BasicAVL() : root(nullptr) {}
+
+    // the tree owns its nodes, a copy would free them a second time
+    BasicAVL(const BasicAVL &) = delete;
+    BasicAVL &operator=(const BasicAVL &) = delete;
+
+    ~BasicAVL()
+    {
+        destroy(root);
+    }
 
-    void insert(int id, string name, int age)
+    void insert(Key id, string_view name, int age)
     {
         // insert the data
-        root = insert(root, id, name, age);
+        RecordFields record{string(name), age};
+        root = insert(root, id, record);
+        clearFinger();
+    }
+
+    // insert a key into a tree without records
+    void insert(Key id)
+    {
+        KeyOnly nothing;
+        root = insert(root, id, nothing);
+        clearFinger();
     }
 
-    void remove(int id)
+    void remove(Key id)
     {
         // delete the data
         root = deleteNode(root, id);
+        clearFinger();
     }
 
-    bool search(int id)
+    bool search(Key id)
     {
         // search for the data
         return search(root, id) != nullptr;
     }
+
+    // the record with the given id, nullptr if there is none
+    Node *find(Key id)
+    {
+        return search(root, id);
+    }
+
+    // root node, for searches that walk the tree themselves (the asynchronous lookups)
+    Node *getRoot()
+    {
+        return root;
+    }
+
+    // call visit on every record in increasing order of id
+    template <typename Visit>
+    void forEach(Visit visit)
+    {
+        forEach(root, visit);
+    }
+
+    // call visit on every record with lo <= id <= hi in increasing order of id
+    template <typename Visit>
+    void forRange(Key lo, Key hi, Visit visit)
+    {
+        forRange(root, lo, hi, visit);
+    }
+
+    // search starting from the last position touched by a hinted call, cheap when ids are close to the previous one
+    bool hintedFind(Key id)
+    {
+        seekFinger(id);
+        return !finger.empty() && finger.back()->id == id;
+    }
+
+    // insert starting from the last position touched by a hinted call
+    // for increasing ids the new node is attached right next to the previous one, without a descent from the root
+    void hintedInsert(Key id, string_view name, int age)
+    {
+        seekFinger(id);
+        if (finger.empty())
+        {
+            root = new Node(id, RecordFields{string(name), age}); // empty tree
+            pushFinger(root, nullptr, nullptr);
+            return;
+        }
+
+        Node *parent = finger.back();
+        if (parent->id == id)
+        {
+            return; // Duplicate IDs not allowed
+        }
+        Node *node = new Node(id, RecordFields{string(name), age});
+        if (id < parent->id)
+        {
+            parent->left = node;
+            pushFinger(node, fingerLo.back(), parent);
+        }
+        else
+        {
+            parent->right = node;
+            pushFinger(node, parent, fingerHi.back());
+        }
+
+        // walk back up the finger fixing heights and sizes, the same work the recursive insert does on its way out
+        for (int depth = finger.size() - 2; depth >= 0; depth--)
+        {
+            Node *old = finger[depth];
+            Node *fixed = rebalance(old);
+            if (fixed != old)
+            {
+                // a rotation replaced the root of this subtree, hook it into its parent
+                if (depth == 0)
+                {
+                    root = fixed;
+                }
+                else if (finger[depth - 1]->left == old)
+                {
+                    finger[depth - 1]->left = fixed;
+                }
+                else
+                {
+                    finger[depth - 1]->right = fixed;
+                }
+                truncateFinger(depth + 1); // the nodes below moved, the subtree still covers the same range
+                finger[depth] = fixed;
+            }
+        }
+    }
+
+    // number of records in the tree
+    int size()
+    {
+        return getSize(root);
+    }
+
+    // number of records with an id smaller than id
+    int rank(Key id)
+    {
+        return rank(root, id, false);
+    }
+
+    // the record with the k-th smallest id (counting from 0), nullptr if k is out of range
+    Node *select(int k)
+    {
+        Node *node = root;
+        while (node)
+        {
+            int leftSize = getSize(node->left);
+            if (k < leftSize)
+            {
+                node = node->left; // the k-th record is in the left subtree
+            }
+            else if (k == leftSize)
+            {
+                return node; // exactly k records are smaller than this one
+            }
+            else
+            {
+                k -= leftSize + 1; // skip the left subtree and this node
+                node = node->right;
+            }
+        }
+        return nullptr;
+    }
+
+    // number of records with lo <= id <= hi
+    int countRange(Key lo, Key hi)
+    {
+        if (lo > hi)
+        {
+            return 0;
+        }
+        return rank(root, hi, true) - rank(root, lo, false);
+    }
+
+    // replace the contents of the tree with the given records
+    // the records are sorted in parallel and the balanced tree is built on all cores instead of one insert at a time
+    // the records are taken over and sorted in place, a caller that still needs them passes a copy
+    void build(vector<Record> &&records)
+    {
+        destroy(root);
+
+        parallelSort(records.begin(), records.end(), [](const Record &a, const Record &b)
+                     { return a.id < b.id; });
+
+        // keep the first record of every id, the same one a serial insert loop would keep
+        records.erase(unique(records.begin(), records.end(), [](const Record &a, const Record &b)
+                             { return a.id == b.id; }),
+                      records.end());
+
+        root = build(records, 0, records.size(), threadBudget());
+        clearFinger();
+    }
+
+    // move the records with ids smaller than id into left and the rest into right, this tree is left empty
+    void split(Key id, BasicAVL &left, BasicAVL &right)
+    {
+        Node *lessTree, *match, *greaterTree;
+        split(root, id, lessTree, match, greaterTree);
+        root = nullptr;
+        clearFinger();
+
+        if (match)
+        {
+            greaterTree = join(nullptr, match, greaterTree); // the record with the id itself goes to the right
+        }
+
+        left.destroy(left.root);
+        left.root = lessTree;
+        left.clearFinger();
+        right.destroy(right.root);
+        right.root = greaterTree;
+        right.clearFinger();
+    }
+
+    // append the records of right after the records of this tree, every id in right must be larger than every id here
+    void join(BasicAVL &right)
+    {
+        root = join(root, right.root);
+        clearFinger();
+        right.root = nullptr;
+        right.clearFinger();
+    }
+
+    // move every record of other into this tree, on duplicate ids the record already here is kept
+    void unionWith(BasicAVL &other)
+    {
+        root = unionOf(root, other.root, threadBudget());
+        clearFinger();
+        other.root = nullptr;
+        other.clearFinger();
+    }
+
+    // keep only the records whose id is also in other, other is left empty
+    void intersectionWith(BasicAVL &other)
+    {
+        root = intersectionOf(root, other.root, threadBudget());
+        clearFinger();
+        other.root = nullptr;
+        other.clearFinger();
+    }
+
+    // remove the records whose id is in other, other is left empty
+    void differenceWith(BasicAVL &other)
+    {
+        int erased = 0;
+        root = differenceOf(root, other.root, erased, threadBudget());
+        clearFinger();
+        other.root = nullptr;
+        other.clearFinger();
+    }
+
+    // insert a whole batch at once, the batch is built into a tree and merged in parallel
+    void insertMany(vector<Record> &&records)
+    {
+        BasicAVL batch;
+        batch.build(move(records));
+        unionWith(batch);
+    }
+
+    // remove every id in [lo, hi], returns the number of records that were removed
+    int eraseRange(Key lo, Key hi)
+    {
+        int erased = 0;
+        if (lo <= hi)
+        {
+            Node *left, *right;
+            eraseRange(root, lo, hi, left, right, erased);
+            root = join(left, right);
+            clearFinger();
+        }
+        return erased;
+    }
+
+    // remove a whole batch of ids at once, returns the number of records that were removed
+    // runs of consecutive ids are cut out as one range, and separate runs are handled in parallel
+    int eraseMany(const vector<int> &ids)
+    {
+        if (!is_sorted(ids.begin(), ids.end()))
+        {
+            vector<int> sorted = ids;
+            parallelSort(sorted.begin(), sorted.end(), less<int>());
+            return eraseMany(sorted);
+        }
+        int erased = 0;
+        root = eraseMany(root, ids, 0, ids.size(), erased, threadBudget());
+        clearFinger();
+        return erased;
+    }
 };
 
+using AVL = BasicAVL<>;
+
 #endif
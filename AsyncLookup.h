@@ -0,0 +1,279 @@
+#ifndef ASYNC_LOOKUP_H
+#define ASYNC_LOOKUP_H
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <vector>
+#include "AVL.h"
+#include "BTree.h"
+using namespace std;
+
+// Asynchronous lookups: a search is a coroutine that prefetches the next node it needs and then suspends,
+// so one thread can keep many searches in flight and work on one while the memory of the others is on its way.
+// Needs C++20 (-std=c++20).
+
+// innermost lookup that suspended during the last resume, read by the scheduler
+// Lookups nest (a request loop awaits find, find walks the tree), so the handle to resume next is not always the outer one
+inline thread_local coroutine_handle<> suspendedLookup;
+
+const int CACHE_LINE = 64;
+
+// Suspension point of a lookup: starts loading [address, address + bytes) into the cache and hands the thread back to the scheduler
+struct PrefetchStep
+{
+    const void *address;
+    size_t bytes;
+
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    void await_suspend(coroutine_handle<> handle) noexcept
+    {
+        // every cache line the object touches, an AVL node is 64 bytes on a 16 byte boundary and mostly straddles two
+        const char *line = (const char *)((uintptr_t)address & ~(uintptr_t)(CACHE_LINE - 1));
+        for (const char *end = (const char *)address + bytes; line < end; line += CACHE_LINE)
+        {
+            __builtin_prefetch(line);
+        }
+        suspendedLookup = handle;
+    }
+
+    void await_resume() noexcept {}
+};
+
+// Coroutine of a lookup returning T
+// It does nothing until the scheduler resumes it, and can be awaited from another Lookup:
+// the awaiting coroutine continues with the result as soon as this one finishes
+template <typename T>
+class Lookup
+{
+public:
+    struct promise_type;
+    using Handle = coroutine_handle<promise_type>;
+
+    // when a lookup finishes, control passes straight to the coroutine awaiting it, or back to the scheduler
+    struct FinalStep
+    {
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        coroutine_handle<> await_suspend(Handle handle) noexcept
+        {
+            coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : noop_coroutine();
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    struct promise_type
+    {
+        T value;
+        coroutine_handle<> continuation; // coroutine awaiting this lookup, null for the outermost one
+
+        Lookup get_return_object()
+        {
+            return Lookup(Handle::from_promise(*this));
+        }
+
+        suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        FinalStep final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_value(T result)
+        {
+            value = result;
+        }
+
+        void unhandled_exception()
+        {
+            terminate();
+        }
+    };
+
+    Lookup(Lookup &&other) noexcept : handle(other.handle)
+    {
+        other.handle = nullptr;
+    }
+
+    Lookup &operator=(Lookup &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+            handle = other.handle;
+            other.handle = nullptr;
+        }
+        return *this;
+    }
+
+    Lookup(const Lookup &) = delete;
+    Lookup &operator=(const Lookup &) = delete;
+
+    ~Lookup()
+    {
+        if (handle)
+        {
+            handle.destroy();
+        }
+    }
+
+    // Awaiting a lookup starts it right away, in the same resume of the scheduler
+    bool await_ready() noexcept
+    {
+        return false;
+    }
+
+    coroutine_handle<> await_suspend(coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume()
+    {
+        return handle.promise().value;
+    }
+
+    Handle getHandle()
+    {
+        return handle;
+    }
+
+    T result()
+    {
+        return handle.promise().value;
+    }
+
+private:
+    Handle handle;
+
+    explicit Lookup(Handle handle) : handle(handle) {}
+};
+
+// Awaitable search of an AVL Tree, the record with the given id or nullptr
+inline Lookup<AVLNode *> find(AVL &tree, int id)
+{
+    AVLNode *node = tree.getRoot();
+    while (node)
+    {
+        if (id == node->id)
+        {
+            co_return node;
+        }
+        node = id < node->id ? node->left : node->right;
+        if (node)
+        {
+            co_await PrefetchStep{node, sizeof(AVLNode)}; // the child is loaded while other lookups run
+        }
+    }
+    co_return nullptr;
+}
+
+// Awaitable search of a B-Tree, the node holding the key or nullptr
+// The keys and the child pointers of a node live in their own arrays, so every level takes two steps:
+// one to load the node, one to load both of its arrays
+inline Lookup<BTreeNode *> find(BTree &tree, int key)
+{
+    BTreeNode *node = tree.getRoot();
+    if (node)
+    {
+        co_await PrefetchStep{node, sizeof(BTreeNode)};
+    }
+    while (node)
+    {
+        __builtin_prefetch(node->children);
+        co_await PrefetchStep{node->keys, (2 * node->t - 1) * sizeof(int)};
+
+        int i = 0;
+        while (i < node->n && key > node->keys[i])
+        {
+            i++;
+        }
+        if (i < node->n && node->keys[i] == key)
+        {
+            co_return node;
+        }
+        if (node->leaf)
+        {
+            co_return nullptr;
+        }
+        node = node->children[i];
+        co_await PrefetchStep{node, sizeof(BTreeNode)};
+    }
+    co_return nullptr;
+}
+
+// Scheduler: runs count lookups on the calling thread with at most inFlight of them in progress at a time
+// start(i) creates lookup i and done(i, result) receives its result. The lookups in progress are resumed round robin,
+// each one runs until its next suspension point, and a finished lookup's slot is given to the next one at once.
+template <typename T, typename Start, typename Done>
+void interleaveLookups(int count, int inFlight, Start start, Done done)
+{
+    struct Slot
+    {
+        Lookup<T> lookup;
+        coroutine_handle<> next; // where the lookup continues, its innermost suspended coroutine
+        int index;
+    };
+
+    vector<Slot> slots;
+    slots.reserve(inFlight);
+    int started = 0;
+    while (started < count && (int)slots.size() < inFlight)
+    {
+        Lookup<T> lookup = start(started);
+        coroutine_handle<> first = lookup.getHandle();
+        slots.push_back(Slot{move(lookup), first, started++});
+    }
+
+    int active = slots.size();
+    while (active > 0)
+    {
+        for (Slot &slot : slots)
+        {
+            if (!slot.next)
+            {
+                continue; // finished and nothing left to start
+            }
+            suspendedLookup = nullptr;
+            slot.next.resume();
+            if (suspendedLookup)
+            {
+                slot.next = suspendedLookup; // waiting on a prefetch
+                continue;
+            }
+
+            // nothing suspended, so the outermost coroutine ran to its end
+            done(slot.index, slot.lookup.result());
+            if (started < count)
+            {
+                slot.lookup = start(started);
+                slot.next = slot.lookup.getHandle();
+                slot.index = started++;
+            }
+            else
+            {
+                slot.next = nullptr;
+                active--;
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,338 @@
+#ifndef BEPSILON_TREE_H
+#define BEPSILON_TREE_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+using namespace std;
+
+// Pending change to a key, kept in the buffer of an internal node until it is flushed to a leaf
+struct BEpsilonMessage
+{
+    int key;
+    bool insert; // true for an insert, false for a delete
+
+    BEpsilonMessage(int key, bool insert)
+        : key(key), insert(insert) {}
+
+    // Orders messages against a key, for searching the sorted buffers
+    static bool before(const BEpsilonMessage &message, int key)
+    {
+        return message.key < key;
+    }
+};
+
+// B^e-Tree Node
+// Child i of an internal node holds the keys k with pivots[i - 1] <= k < pivots[i]
+struct BEpsilonNode
+{
+    vector<int> keys;                // Sorted keys of a leaf
+    vector<int> pivots;              // Separators of an internal node, one fewer than its children
+    vector<BEpsilonNode *> children; // Array of child pointers
+    vector<BEpsilonMessage> buffer;  // Pending messages of an internal node, sorted by key, at most one per key
+    bool leaf;                       // Is true if node is a leaf
+
+    BEpsilonNode(bool leaf)
+    {
+        this->leaf = leaf;
+    }
+
+    // Index of the child whose range holds the key
+    int childIndex(int key)
+    {
+        return upper_bound(pivots.begin(), pivots.end(), key) - pivots.begin();
+    }
+};
+
+// B^e-Tree Class
+// Write-optimized B-Tree: a node of nodeSize slots spends nodeSize^e of them on children and the rest on a
+// buffer of pending inserts and deletes. Updates stop at the root buffer, and a full buffer is flushed one
+// batch at a time into the child that has the most messages waiting, so every node touched on the way down
+// is paid for by many updates instead of one.
+// Keys are a set, inserting a present key or deleting a missing one does nothing.
+// Nodes emptied by deletes are not merged, they are reused by later inserts into the same range.
+class BEpsilonTree
+{
+private:
+    BEpsilonNode *root;
+    int fanout;         // Most children of an internal node
+    int bufferCapacity; // Most messages an internal node holds before it is flushed
+    int leafCapacity;   // Most keys of a leaf
+
+    void destroy(BEpsilonNode *node);
+    long long buffered(BEpsilonNode *node);
+
+    bool overfull(BEpsilonNode *node);
+    void put(BEpsilonMessage message);
+    void apply(BEpsilonNode *leaf, const BEpsilonMessage *first, const BEpsilonMessage *last);
+    void flush(BEpsilonNode *node);
+    void splitChild(BEpsilonNode *node, int i);
+    void splitOverfull(BEpsilonNode *node, int i);
+
+public:
+    BEpsilonTree(int nodeSize, double epsilon = 0.5)
+    {
+        root = nullptr;
+        fanout = max(2, (int)round(pow(nodeSize, epsilon)));
+        bufferCapacity = max(1, nodeSize - fanout);
+        leafCapacity = max(2, nodeSize);
+    }
+
+    // The tree owns its nodes and their buffers, a copy would free them a second time
+    BEpsilonTree(const BEpsilonTree &) = delete;
+    BEpsilonTree &operator=(const BEpsilonTree &) = delete;
+
+    ~BEpsilonTree()
+    {
+        destroy(root);
+    }
+
+    void insert(int key)
+    {
+        put(BEpsilonMessage(key, true));
+    }
+
+    void remove(int key)
+    {
+        put(BEpsilonMessage(key, false));
+    }
+
+    bool search(int key);
+
+    // Messages still waiting in the buffers of internal nodes
+    long long buffered()
+    {
+        return buffered(root);
+    }
+};
+
+// Free a node and every node below it
+void BEpsilonTree::destroy(BEpsilonNode *node)
+{
+    if (!node)
+    {
+        return;
+    }
+    for (BEpsilonNode *child : node->children)
+    {
+        destroy(child);
+    }
+    delete node;
+}
+
+long long BEpsilonTree::buffered(BEpsilonNode *node)
+{
+    if (!node)
+    {
+        return 0;
+    }
+    long long total = node->buffer.size();
+    for (BEpsilonNode *child : node->children)
+    {
+        total += buffered(child);
+    }
+    return total;
+}
+
+// Search for a key, the newest message on the way down decides before the leaf is reached
+bool BEpsilonTree::search(int key)
+{
+    BEpsilonNode *node = root;
+    while (node && !node->leaf)
+    {
+        auto it = lower_bound(node->buffer.begin(), node->buffer.end(), key, BEpsilonMessage::before);
+        if (it != node->buffer.end() && it->key == key)
+        {
+            return it->insert;
+        }
+        node = node->children[node->childIndex(key)];
+    }
+    return node && binary_search(node->keys.begin(), node->keys.end(), key);
+}
+
+bool BEpsilonTree::overfull(BEpsilonNode *node)
+{
+    return node->leaf ? (int)node->keys.size() > leafCapacity : (int)node->children.size() > fanout;
+}
+
+// Add a message to the root, flushing and splitting as needed
+void BEpsilonTree::put(BEpsilonMessage message)
+{
+    if (!root)
+    {
+        root = new BEpsilonNode(true);
+    }
+
+    if (root->leaf)
+    {
+        apply(root, &message, &message + 1);
+    }
+    else
+    {
+        // a newer message for the same key replaces the older one
+        auto it = lower_bound(root->buffer.begin(), root->buffer.end(), message.key, BEpsilonMessage::before);
+        if (it != root->buffer.end() && it->key == message.key)
+        {
+            *it = message;
+        }
+        else
+        {
+            root->buffer.insert(it, message);
+        }
+        if ((int)root->buffer.size() > bufferCapacity)
+        {
+            flush(root);
+        }
+    }
+
+    if (overfull(root))
+    {
+        // grow the tree by one level, the old root becomes the only child of the new one
+        BEpsilonNode *s = new BEpsilonNode(false);
+        s->children.push_back(root);
+        root = s;
+        splitOverfull(root, 0);
+    }
+}
+
+// Apply sorted messages to the keys of a leaf by merging the two sorted lists
+void BEpsilonTree::apply(BEpsilonNode *leaf, const BEpsilonMessage *first, const BEpsilonMessage *last)
+{
+    vector<int> merged;
+    merged.reserve(leaf->keys.size() + (last - first));
+    auto key = leaf->keys.begin();
+    for (auto message = first; message != last; ++message)
+    {
+        while (key != leaf->keys.end() && *key < message->key)
+        {
+            merged.push_back(*key++);
+        }
+        if (key != leaf->keys.end() && *key == message->key)
+        {
+            key++; // the message decides whether the key stays
+        }
+        if (message->insert)
+        {
+            merged.push_back(message->key);
+        }
+    }
+    merged.insert(merged.end(), key, leaf->keys.end());
+    leaf->keys.swap(merged);
+}
+
+// Move messages from the buffer of a node down until the buffer fits again
+// Messages for one child sit next to each other in the sorted buffer, so every batch is one contiguous run
+void BEpsilonTree::flush(BEpsilonNode *node)
+{
+    while ((int)node->buffer.size() > bufferCapacity)
+    {
+        // find the child with the most messages waiting
+        int best = 0, bestBegin = 0, bestEnd = 0;
+        int begin = 0;
+        for (int i = 0; i < (int)node->children.size(); i++)
+        {
+            int end = node->buffer.size();
+            if (i < (int)node->pivots.size())
+            {
+                auto bound = lower_bound(node->buffer.begin() + begin, node->buffer.end(), node->pivots[i], BEpsilonMessage::before);
+                end = bound - node->buffer.begin();
+            }
+            if (end - begin > bestEnd - bestBegin)
+            {
+                best = i;
+                bestBegin = begin;
+                bestEnd = end;
+            }
+            begin = end;
+        }
+
+        BEpsilonNode *child = node->children[best];
+        auto first = node->buffer.begin() + bestBegin;
+        auto last = node->buffer.begin() + bestEnd;
+        if (child->leaf)
+        {
+            apply(child, &*first, &*first + (last - first));
+        }
+        else
+        {
+            // merge the batch into the child's buffer, the parent's messages are newer and win on equal keys
+            vector<BEpsilonMessage> merged;
+            merged.reserve(child->buffer.size() + (last - first));
+            auto older = child->buffer.begin();
+            for (auto newer = first; newer != last; ++newer)
+            {
+                while (older != child->buffer.end() && older->key < newer->key)
+                {
+                    merged.push_back(*older++);
+                }
+                if (older != child->buffer.end() && older->key == newer->key)
+                {
+                    older++;
+                }
+                merged.push_back(*newer);
+            }
+            merged.insert(merged.end(), older, child->buffer.end());
+            child->buffer.swap(merged);
+            if ((int)child->buffer.size() > bufferCapacity)
+            {
+                flush(child);
+            }
+        }
+        node->buffer.erase(first, last);
+
+        splitOverfull(node, best);
+    }
+}
+
+// Split child i of a node in two halves, the right half becomes child i + 1
+void BEpsilonTree::splitChild(BEpsilonNode *node, int i)
+{
+    BEpsilonNode *y = node->children[i];
+    BEpsilonNode *z = new BEpsilonNode(y->leaf);
+    int separator;
+
+    if (y->leaf)
+    {
+        int mid = y->keys.size() / 2;
+        separator = y->keys[mid];
+        z->keys.assign(y->keys.begin() + mid, y->keys.end());
+        y->keys.resize(mid);
+    }
+    else
+    {
+        int mid = y->children.size() / 2;
+        separator = y->pivots[mid - 1];
+        z->pivots.assign(y->pivots.begin() + mid, y->pivots.end());
+        z->children.assign(y->children.begin() + mid, y->children.end());
+        y->pivots.resize(mid - 1);
+        y->children.resize(mid);
+
+        // pending messages follow their keys into the half that now owns them
+        auto split = lower_bound(y->buffer.begin(), y->buffer.end(), separator, BEpsilonMessage::before);
+        z->buffer.assign(split, y->buffer.end());
+        y->buffer.erase(split, y->buffer.end());
+    }
+
+    node->pivots.insert(node->pivots.begin() + i, separator);
+    node->children.insert(node->children.begin() + i + 1, z);
+}
+
+// Split child i until it and the nodes split off it fit, a big batch can overfill a leaf several times over
+void BEpsilonTree::splitOverfull(BEpsilonNode *node, int i)
+{
+    int end = i + 1;
+    while (i < end)
+    {
+        if (overfull(node->children[i]))
+        {
+            splitChild(node, i);
+            end++;
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+#endif
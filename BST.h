@@ -1,7 +1,11 @@
 #ifndef BST_H
 #define BST_H
 
+#include <algorithm>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "KeyRuns.h"
 using namespace std;
 
 // structure for Node containing data and pointers to left and right children in a Binary Search Tree
@@ -14,7 +18,7 @@ struct BSTNode
     BSTNode *right;
 
     BSTNode(int id, string name, int age)
-        : id(id), name(name), age(age), left(nullptr), right(nullptr) {}
+        : id(id), name(move(name)), age(age), left(nullptr), right(nullptr) {}
 };
 
 // Binary Search Tree
@@ -23,12 +27,12 @@ class BinarySearchTree
 private:
     BSTNode *root; // root node of the Binary Search Tree
 
-    BSTNode *insert(BSTNode *node, int id, string name, int age)
+    BSTNode *insert(BSTNode *node, int id, string_view name, int age)
     {
         // if node is null then create a new node
         if (!node)
         {
-            return new BSTNode(id, name, age);
+            return new BSTNode(id, string(name), age);
         }
         // if id is less than the id of the node then insert in the left subtree
         if (id < node->id)
@@ -119,10 +123,112 @@ private:
         return node; // return the node
     }
 
+    // free a subtree and return the number of nodes freed
+    int destroy(BSTNode *node)
+    {
+        if (!node)
+        {
+            return 0;
+        }
+        int freed = destroy(node->left) + destroy(node->right) + 1;
+        delete node;
+        return freed;
+    }
+
+    // keep only the ids smaller than lo, every right subtree past the boundary is freed whole
+    BSTNode *keepBelow(BSTNode *node, int lo, int &erased)
+    {
+        if (!node)
+        {
+            return nullptr;
+        }
+        if (node->id < lo)
+        {
+            node->right = keepBelow(node->right, lo, erased); // node stays, only its right subtree crosses lo
+            return node;
+        }
+        erased += destroy(node->right) + 1; // node and everything right of it are >= lo
+        BSTNode *left = node->left;
+        delete node;
+        return keepBelow(left, lo, erased);
+    }
+
+    // keep only the ids larger than hi, every left subtree past the boundary is freed whole
+    BSTNode *keepAbove(BSTNode *node, int hi, int &erased)
+    {
+        if (!node)
+        {
+            return nullptr;
+        }
+        if (node->id > hi)
+        {
+            node->left = keepAbove(node->left, hi, erased); // node stays, only its left subtree crosses hi
+            return node;
+        }
+        erased += destroy(node->left) + 1; // node and everything left of it are <= hi
+        BSTNode *right = node->right;
+        delete node;
+        return keepAbove(right, hi, erased);
+    }
+
+    // remove the ids in [lo, hi], only the two boundary paths are walked and everything between them is freed whole
+    BSTNode *eraseRange(BSTNode *node, int lo, int hi, int &erased)
+    {
+        if (!node)
+        {
+            return nullptr;
+        }
+        if (node->id < lo)
+        {
+            node->right = eraseRange(node->right, lo, hi, erased); // the whole range is right of node
+            return node;
+        }
+        if (node->id > hi)
+        {
+            node->left = eraseRange(node->left, lo, hi, erased); // the whole range is left of node
+            return node;
+        }
+
+        // node is in the range, so its left subtree only loses ids >= lo and its right subtree only ids <= hi
+        BSTNode *left = node->id > lo ? keepBelow(node->left, lo, erased) : node->left;
+        BSTNode *right = node->id < hi ? keepAbove(node->right, hi, erased) : node->right;
+        delete node;
+        erased++;
+
+        if (!left || !right)
+        {
+            return left ? left : right;
+        }
+        // the smallest id of the right side takes the place of node, like the inorder successor in deleteNode
+        BSTNode *parent = nullptr;
+        BSTNode *successor = right;
+        while (successor->left)
+        {
+            parent = successor;
+            successor = successor->left;
+        }
+        if (parent)
+        {
+            parent->left = successor->right;
+            successor->right = right;
+        }
+        successor->left = left;
+        return successor;
+    }
+
 public:
     BinarySearchTree() : root(nullptr) {}
 
-    void insert(int id, string name, int age)
+    // the tree owns its nodes, a copy would free them a second time
+    BinarySearchTree(const BinarySearchTree &) = delete;
+    BinarySearchTree &operator=(const BinarySearchTree &) = delete;
+
+    ~BinarySearchTree()
+    {
+        destroy(root);
+    }
+
+    void insert(int id, string_view name, int age)
     {
         // insert the data
         root = insert(root, id, name, age);
@@ -139,6 +245,36 @@ public:
         // delete the data
         root = deleteNode(root, id);
     }
+
+    // remove every id in [lo, hi], returns the number of records that were removed
+    int eraseRange(int lo, int hi)
+    {
+        int erased = 0;
+        if (lo <= hi)
+        {
+            root = eraseRange(root, lo, hi, erased);
+        }
+        return erased;
+    }
+
+    // remove a whole batch of ids at once, returns the number of records that were removed
+    // runs of consecutive ids are removed as one range
+    int eraseMany(const vector<int> &ids)
+    {
+        if (!is_sorted(ids.begin(), ids.end()))
+        {
+            vector<int> sorted = ids;
+            sort(sorted.begin(), sorted.end());
+            return eraseMany(sorted);
+        }
+        int erased = 0;
+        for (int first = 0, last; first < (int)ids.size(); first = last)
+        {
+            last = runEnd(ids, first);
+            erased += eraseRange(ids[first], ids[last - 1]);
+        }
+        return erased;
+    }
 };
 
 #endif
@@ -1,16 +1,25 @@
 #ifndef BTREE_H
 #define BTREE_H
 
+#include <climits>
 #include <iostream>
 #include <string>
+#include <vector>
+#include "KeyRuns.h"
+#include "Parallel.h"
 using namespace std;
 
+// Runs of fewer consecutive keys than this are erased key by key, cutting a range out of the tree touches
+// about as many nodes as this many single removes
+const int RANGE_ERASE_MIN_RUN = 64;
+
 // B-Tree Node
 struct BTreeNode
 {
     int *keys;            // Array of keys
     int t;                // Minimum degree
     BTreeNode **children; // Array of child pointers
+    int *counts;          // Number of keys in the subtree of each child
     int n;                // Current number of keys
     bool leaf;            // Is true if node is a leaf
 
@@ -21,6 +30,7 @@ struct BTreeNode
 
         keys = new int[2 * t - 1];
         children = new BTreeNode *[2 * t];
+        counts = new int[2 * t];
         n = 0;
     }
 
@@ -28,6 +38,21 @@ struct BTreeNode
     {
         delete[] keys;
         delete[] children;
+        delete[] counts;
+    }
+
+    // Number of keys in the subtree rooted at this node
+    int size()
+    {
+        int total = n;
+        if (!leaf)
+        {
+            for (int i = 0; i <= n; i++)
+            {
+                total += counts[i];
+            }
+        }
+        return total;
     }
 
     void traverse()
@@ -69,7 +94,7 @@ struct BTreeNode
 
     void insertNonFull(int key);
     void splitChild(int i, BTreeNode *y);
-    void remove(int key);
+    bool remove(int key);
     void removeFromLeaf(int idx);
     void removeFromNonLeaf(int idx);
     int getPredecessor(int idx);
@@ -87,6 +112,37 @@ private:
     BTreeNode *root;
     int t;
 
+    // Finger: the path from the root to the node last touched by a hinted call
+    // fingerIndex[i] is the child of finger[i] that leads to finger[i + 1]
+    // Keys in the subtree of finger[i] lie between fingerLo[i] and fingerHi[i]
+    // Any other change to the tree clears it, and the next hinted call starts again from the root
+    vector<BTreeNode *> finger;
+    vector<int> fingerIndex;
+    vector<long long> fingerLo;
+    vector<long long> fingerHi;
+
+    void clearFinger();
+    void truncateFinger(int length);
+    void pushFinger(BTreeNode *node, long long lo, long long hi);
+    bool seekFinger(int key, bool forInsert);
+
+    bool removeKey(int key);
+    void destroy(BTreeNode *node);
+    long long maxKeys(int height);
+    int rank(int key, bool inclusive);
+    BTreeNode *build(const vector<int> &keys, int lo, int hi, int height, bool isRoot, int threads);
+
+    // A fragment is a B-Tree given by its root and height (a leaf has height 0, an empty fragment is nullptr with height -1)
+    // Its root may hold fewer than t - 1 keys, every other node is a valid B-Tree node
+    int height();
+    BTreeNode *pack(const vector<int> &keys, const vector<BTreeNode *> &children, bool leaf, bool &grew);
+    BTreeNode *joinEqual(BTreeNode *left, int key, BTreeNode *right, bool leaf, bool &grew);
+    BTreeNode *joinRight(BTreeNode *left, int leftHeight, int key, BTreeNode *right, int rightHeight, bool &grew);
+    BTreeNode *joinLeft(BTreeNode *left, int leftHeight, int key, BTreeNode *right, int rightHeight, bool &grew);
+    BTreeNode *join(BTreeNode *left, int leftHeight, int key, BTreeNode *right, int rightHeight, int &height);
+    BTreeNode *join(BTreeNode *left, int leftHeight, BTreeNode *right, int rightHeight);
+    void split(BTreeNode *node, int height, int key, bool inclusive, BTreeNode *&left, int &leftHeight, BTreeNode *&right, int &rightHeight);
+
 public:
     BTree(int t)
     {
@@ -94,9 +150,13 @@ public:
         this->t = t;
     }
 
+    // The tree owns its nodes, a copy would free them a second time
+    BTree(const BTree &) = delete;
+    BTree &operator=(const BTree &) = delete;
+
     ~BTree()
     {
-        delete root;
+        destroy(root);
     }
 
     void traverse()
@@ -112,13 +172,37 @@ public:
         return root ? root->search(key) : nullptr;
     }
 
+    // Root node, for searches that walk the tree themselves (the asynchronous lookups)
+    BTreeNode *getRoot()
+    {
+        return root;
+    }
+
     void insert(int key);
     void remove(int key);
+    void build(vector<int> keys);
+
+    bool hintedFind(int key);
+    void hintedInsert(int key);
+
+    int size()
+    {
+        return root ? root->size() : 0;
+    }
+
+    int rank(int key);
+    bool select(int k, int &key);
+    int countRange(int lo, int hi);
+
+    int eraseRange(int lo, int hi);
+    int eraseMany(const vector<int> &keys);
 };
 
 // Insert a key into the B-Tree
 void BTree::insert(int key)
 {
+    clearFinger();
+
     if (!root)
     {
         root = new BTreeNode(t, true);
@@ -139,6 +223,7 @@ void BTree::insert(int key)
                 i++;
             }
             s->children[i]->insertNonFull(key);
+            s->counts[i]++;
 
             root = s;
         }
@@ -149,6 +234,256 @@ void BTree::insert(int key)
     }
 }
 
+// Free a node and every node below it
+void BTree::destroy(BTreeNode *node)
+{
+    if (!node)
+    {
+        return;
+    }
+    if (!node->leaf)
+    {
+        for (int i = 0; i <= node->n; i++)
+        {
+            destroy(node->children[i]);
+        }
+    }
+    delete node;
+}
+
+// Largest number of keys a subtree of the given height can hold, (2t)^(height + 1) - 1
+long long BTree::maxKeys(int height)
+{
+    long long capacity = 1;
+    for (int i = 0; i <= height; i++)
+    {
+        capacity *= 2 * t;
+    }
+    return capacity - 1;
+}
+
+// Build a subtree of the given height from the sorted keys in [lo, hi)
+BTreeNode *BTree::build(const vector<int> &keys, int lo, int hi, int height, bool isRoot, int threads)
+{
+    int count = hi - lo;
+
+    if (height == 0)
+    {
+        // leaf level: pack the whole range into one node
+        BTreeNode *leaf = new BTreeNode(t, true);
+        for (int i = 0; i < count; i++)
+        {
+            leaf->keys[i] = keys[lo + i];
+        }
+        leaf->n = count;
+        return leaf;
+    }
+
+    // use as few children as fit, but at least t so the node is not underfull (the root only needs 2)
+    long long childCapacity = maxKeys(height - 1) + 1;
+    int c = (count + childCapacity) / childCapacity;
+    if (!isRoot && c < t)
+    {
+        c = t;
+    }
+
+    // the keys left after taking c - 1 separators are spread evenly over the children
+    int rest = count - (c - 1);
+    int base = rest / c;
+    int extra = rest % c;
+
+    BTreeNode *node = new BTreeNode(t, false);
+    node->n = c - 1;
+
+    vector<int> starts(c + 1);
+    starts[0] = lo;
+    for (int i = 0; i < c; i++)
+    {
+        int size = base + (i < extra ? 1 : 0);
+        starts[i + 1] = starts[i] + size + 1; // child keys followed by the separator
+        if (i < c - 1)
+        {
+            node->keys[i] = keys[starts[i] + size];
+        }
+    }
+
+    // children are independent, so split the thread budget between them
+    vector<thread> workers;
+    for (int i = 0; i < c; i++)
+    {
+        int share = max(1, threads / c + (i < threads % c ? 1 : 0));
+        int end = starts[i + 1] - 1; // exclude the separator
+        if (threads > 1 && i < threads - 1 && i < c - 1)
+        {
+            workers.emplace_back([this, node, &keys, &starts, i, end, height, share]()
+                                 { node->children[i] = build(keys, starts[i], end, height - 1, false, share); });
+        }
+        else
+        {
+            node->children[i] = build(keys, starts[i], end, height - 1, false, share);
+        }
+    }
+    for (thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (int i = 0; i < c; i++)
+    {
+        node->counts[i] = starts[i + 1] - 1 - starts[i];
+    }
+
+    return node;
+}
+
+// Replace the contents of the B-Tree with the given keys
+// The keys are sorted in parallel and the packed leaf level and the levels above it are built on all cores
+void BTree::build(vector<int> keys)
+{
+    clearFinger();
+    destroy(root);
+    root = nullptr;
+
+    if (keys.empty())
+    {
+        return;
+    }
+
+    parallelSort(keys.begin(), keys.end(), less<int>());
+
+    // smallest height that can hold every key
+    int height = 0;
+    while (maxKeys(height) < (long long)keys.size())
+    {
+        height++;
+    }
+
+    root = build(keys, 0, keys.size(), height, true, threadBudget());
+}
+
+void BTree::clearFinger()
+{
+    truncateFinger(0);
+}
+
+void BTree::truncateFinger(int length)
+{
+    finger.resize(length);
+    fingerIndex.resize(length);
+    fingerLo.resize(length);
+    fingerHi.resize(length);
+}
+
+void BTree::pushFinger(BTreeNode *node, long long lo, long long hi)
+{
+    finger.push_back(node);
+    fingerIndex.push_back(0);
+    fingerLo.push_back(lo);
+    fingerHi.push_back(hi);
+}
+
+// Move the finger towards key, returns true if the key was found on the way
+// For inserts the finger ends at the leaf the key belongs in, equal keys go to the right like in insertNonFull
+bool BTree::seekFinger(int key, bool forInsert)
+{
+    if (!root)
+    {
+        clearFinger();
+        return false;
+    }
+
+    if (finger.empty())
+    {
+        pushFinger(root, LLONG_MIN, LLONG_MAX); // start again from the root
+    }
+    else
+    {
+        // climb until the subtree can hold the key, for nearby keys that is only a few steps
+        // a search has to leave a subtree whose bound equals the key, the key may sit in an ancestor
+        int depth = finger.size();
+        while (depth > 1)
+        {
+            long long lo = fingerLo[depth - 1], hi = fingerHi[depth - 1];
+            bool inside = forInsert ? (lo <= key && key <= hi) : (lo < key && key < hi);
+            if (inside)
+            {
+                break;
+            }
+            depth--;
+        }
+        truncateFinger(depth);
+    }
+
+    // then walk down from there as usual
+    BTreeNode *cur = finger.back();
+    while (true)
+    {
+        int i = 0;
+        if (forInsert)
+        {
+            while (i < cur->n && cur->keys[i] <= key)
+            {
+                i++;
+            }
+        }
+        else
+        {
+            while (i < cur->n && cur->keys[i] < key)
+            {
+                i++;
+            }
+            if (i < cur->n && cur->keys[i] == key)
+            {
+                return true;
+            }
+        }
+
+        if (cur->leaf)
+        {
+            return false;
+        }
+
+        fingerIndex.back() = i;
+        long long lo = i > 0 ? cur->keys[i - 1] : fingerLo.back();
+        long long hi = i < cur->n ? cur->keys[i] : fingerHi.back();
+        cur = cur->children[i];
+        pushFinger(cur, lo, hi);
+    }
+}
+
+// Search starting from the last position touched by a hinted call, cheap when keys are close to the previous one
+bool BTree::hintedFind(int key)
+{
+    return seekFinger(key, false);
+}
+
+// Insert starting from the last position touched by a hinted call
+// For increasing keys that is the rightmost leaf, which is reused until it fills up
+void BTree::hintedInsert(int key)
+{
+    seekFinger(key, true);
+
+    // the deepest node on the finger with room for one more key, full nodes below it are split on the way down
+    int depth = finger.size() - 1;
+    while (depth >= 0 && finger[depth]->n == 2 * t - 1)
+    {
+        depth--;
+    }
+
+    if (depth < 0)
+    {
+        insert(key); // empty tree, or every node up to the root is full and the root has to split
+        return;
+    }
+
+    for (int i = 0; i < depth; i++)
+    {
+        finger[i]->counts[fingerIndex[i]]++; // the key lands in the subtree the finger goes through
+    }
+    finger[depth]->insertNonFull(key);
+    truncateFinger(depth + 1); // nodes below may have split, the rest of the path is found again next time
+}
+
 // Insert a key into a non-full node
 void BTreeNode::insertNonFull(int key)
 {
@@ -180,6 +515,7 @@ void BTreeNode::insertNonFull(int key)
             }
         }
         children[i + 1]->insertNonFull(key);
+        counts[i + 1]++;
     }
 }
 
@@ -199,6 +535,7 @@ void BTreeNode::splitChild(int i, BTreeNode *y)
         for (int j = 0; j < t; j++)
         {
             z->children[j] = y->children[j + t];
+            z->counts[j] = y->counts[j + t];
         }
     }
 
@@ -207,9 +544,12 @@ void BTreeNode::splitChild(int i, BTreeNode *y)
     for (int j = n; j >= i + 1; j--)
     {
         children[j + 1] = children[j];
+        counts[j + 1] = counts[j];
     }
 
     children[i + 1] = z;
+    counts[i] = y->size();
+    counts[i + 1] = z->size();
 
     for (int j = n - 1; j >= i; j--)
     {
@@ -223,13 +563,29 @@ void BTreeNode::splitChild(int i, BTreeNode *y)
 // Remove a key from the B-Tree
 void BTree::remove(int key)
 {
+    clearFinger();
+
     if (!root)
     {
         cout << "The tree is empty.\n";
         return;
     }
 
-    root->remove(key);
+    if (!removeKey(key))
+    {
+        cout << "The key " << key << " is not in the tree.\n";
+    }
+}
+
+// Remove one copy of a key without printing anything, returns false if the key is not in the tree
+bool BTree::removeKey(int key)
+{
+    if (!root)
+    {
+        return false;
+    }
+
+    bool removed = root->remove(key);
 
     if (root->n == 0)
     {
@@ -237,10 +593,11 @@ void BTree::remove(int key)
         root = root->leaf ? nullptr : root->children[0];
         delete temp;
     }
+    return removed;
 }
 
-// Remove a key from a node
-void BTreeNode::remove(int key)
+// Remove a key from a node, returns false if the key is not in the subtree
+bool BTreeNode::remove(int key)
 {
     int idx = 0;
     while (idx < n && keys[idx] < key)
@@ -258,13 +615,13 @@ void BTreeNode::remove(int key)
         {
             removeFromNonLeaf(idx);
         }
+        return true;
     }
     else
     {
         if (leaf)
         {
-            cout << "The key " << key << " is not in the tree.\n";
-            return;
+            return false;
         }
 
         bool flag = (idx == n);
@@ -275,12 +632,15 @@ void BTreeNode::remove(int key)
 
         if (flag && idx > n)
         {
-            children[idx - 1]->remove(key);
+            idx--;
         }
-        else
+
+        if (!children[idx]->remove(key))
         {
-            children[idx]->remove(key);
+            return false;
         }
+        counts[idx]--;
+        return true;
     }
 }
 
@@ -304,17 +664,20 @@ void BTreeNode::removeFromNonLeaf(int idx)
         int pred = getPredecessor(idx);
         keys[idx] = pred;
         children[idx]->remove(pred);
+        counts[idx]--;
     }
     else if (children[idx + 1]->n >= t)
     {
         int succ = getSuccessor(idx);
         keys[idx] = succ;
         children[idx + 1]->remove(succ);
+        counts[idx + 1]--;
     }
     else
     {
         merge(idx);
         children[idx]->remove(k);
+        counts[idx]--;
     }
 }
 
@@ -380,6 +743,7 @@ void BTreeNode::borrowFromPrev(int idx)
         for (int i = child->n; i >= 0; i--)
         {
             child->children[i + 1] = child->children[i];
+            child->counts[i + 1] = child->counts[i];
         }
     }
 
@@ -390,6 +754,16 @@ void BTreeNode::borrowFromPrev(int idx)
     }
     keys[idx - 1] = sibling->keys[sibling->n - 1];
 
+    // the separator moves down into child, along with the last subtree of sibling
+    int moved = 1;
+    if (!child->leaf)
+    {
+        child->counts[0] = sibling->counts[sibling->n];
+        moved += child->counts[0];
+    }
+    counts[idx] += moved;
+    counts[idx - 1] -= moved;
+
     child->n++;
     sibling->n--;
 }
@@ -406,6 +780,16 @@ void BTreeNode::borrowFromNext(int idx)
         child->children[child->n + 1] = sibling->children[0];
     }
 
+    // the separator moves down into child, along with the first subtree of sibling
+    int moved = 1;
+    if (!child->leaf)
+    {
+        child->counts[child->n + 1] = sibling->counts[0];
+        moved += sibling->counts[0];
+    }
+    counts[idx] += moved;
+    counts[idx + 1] -= moved;
+
     keys[idx] = sibling->keys[0];
 
     for (int i = 1; i < sibling->n; i++)
@@ -418,6 +802,7 @@ void BTreeNode::borrowFromNext(int idx)
         for (int i = 1; i <= sibling->n; i++)
         {
             sibling->children[i - 1] = sibling->children[i];
+            sibling->counts[i - 1] = sibling->counts[i];
         }
     }
 
@@ -443,6 +828,7 @@ void BTreeNode::merge(int idx)
         for (int i = 0; i <= sibling->n; i++)
         {
             child->children[i + t] = sibling->children[i];
+            child->counts[i + t] = sibling->counts[i];
         }
     }
 
@@ -451,9 +837,12 @@ void BTreeNode::merge(int idx)
         keys[i - 1] = keys[i];
     }
 
+    counts[idx] += 1 + counts[idx + 1]; // child now also holds the separator and everything in sibling
+
     for (int i = idx + 2; i <= n; i++)
     {
         children[i - 1] = children[i];
+        counts[i - 1] = counts[i];
     }
 
     child->n += sibling->n + 1;
@@ -462,4 +851,499 @@ void BTreeNode::merge(int idx)
     delete sibling;
 }
 
-#endif
\ No newline at end of file
+// Number of keys smaller than key, or smaller than or equal to key when inclusive is true
+int BTree::rank(int key, bool inclusive)
+{
+    int count = 0;
+    BTreeNode *cur = root;
+    while (cur)
+    {
+        int i = 0;
+        while (i < cur->n && (cur->keys[i] < key || (inclusive && cur->keys[i] == key)))
+        {
+            if (!cur->leaf)
+            {
+                count += cur->counts[i]; // the whole subtree left of keys[i] is counted
+            }
+            count++; // and keys[i] itself
+            i++;
+        }
+        cur = cur->leaf ? nullptr : cur->children[i];
+    }
+    return count;
+}
+
+// Number of keys smaller than key
+int BTree::rank(int key)
+{
+    return rank(key, false);
+}
+
+// The k-th smallest key (counting from 0), returns false if k is out of range
+bool BTree::select(int k, int &key)
+{
+    if (k < 0 || k >= size())
+    {
+        return false;
+    }
+
+    BTreeNode *cur = root;
+    while (true)
+    {
+        for (int i = 0; i <= cur->n; i++)
+        {
+            int below = cur->leaf ? 0 : cur->counts[i];
+            if (k < below)
+            {
+                cur = cur->children[i]; // the k-th key is inside this child
+                break;
+            }
+            k -= below;
+            if (k == 0 && i < cur->n)
+            {
+                key = cur->keys[i];
+                return true;
+            }
+            k--; // skip keys[i]
+        }
+    }
+}
+
+// Number of keys with lo <= key <= hi
+int BTree::countRange(int lo, int hi)
+{
+    if (lo > hi)
+    {
+        return 0;
+    }
+    return rank(hi, true) - rank(lo, false);
+}
+
+// Height of the tree, a single leaf has height 0
+int BTree::height()
+{
+    int h = 0;
+    for (BTreeNode *cur = root; cur && !cur->leaf; cur = cur->children[0])
+    {
+        h++;
+    }
+    return h;
+}
+
+// Make a node from sorted keys and the children between them
+// Too many keys for one node are split around the middle key, which becomes a new parent and grew is set
+BTreeNode *BTree::pack(const vector<int> &keys, const vector<BTreeNode *> &children, bool leaf, bool &grew)
+{
+    int count = keys.size();
+    grew = count > 2 * t - 1;
+
+    // halves of at most 4t - 1 keys hold between t - 1 and 2t - 1 keys each
+    int parts = grew ? 2 : 1;
+    int mid = grew ? count / 2 : count;
+    BTreeNode *part[2];
+    for (int p = 0; p < parts; p++)
+    {
+        int first = p == 0 ? 0 : mid + 1;
+        int last = p == 0 ? mid : count;
+        BTreeNode *node = new BTreeNode(t, leaf);
+        node->n = last - first;
+        for (int i = first; i < last; i++)
+        {
+            node->keys[i - first] = keys[i];
+        }
+        if (!leaf)
+        {
+            for (int i = first; i <= last; i++)
+            {
+                node->children[i - first] = children[i];
+                node->counts[i - first] = children[i]->size();
+            }
+        }
+        part[p] = node;
+    }
+
+    if (!grew)
+    {
+        return part[0];
+    }
+    BTreeNode *parent = new BTreeNode(t, false);
+    parent->n = 1;
+    parent->keys[0] = keys[mid];
+    for (int p = 0; p < 2; p++)
+    {
+        parent->children[p] = part[p];
+        parent->counts[p] = part[p]->size();
+    }
+    return parent;
+}
+
+// Join two fragments of the same height around a key, either into one node or into two under a new parent
+// A missing side (nullptr) only happens at the leaf level and adds no keys
+BTreeNode *BTree::joinEqual(BTreeNode *left, int key, BTreeNode *right, bool leaf, bool &grew)
+{
+    int total = (left ? left->n : 0) + 1 + (right ? right->n : 0);
+    if (left && total <= 2 * t - 1)
+    {
+        // everything fits into left, append the key and the contents of right
+        left->keys[left->n] = key;
+        if (right)
+        {
+            for (int i = 0; i < right->n; i++)
+            {
+                left->keys[left->n + 1 + i] = right->keys[i];
+            }
+            if (!leaf)
+            {
+                for (int i = 0; i <= right->n; i++)
+                {
+                    left->children[left->n + 1 + i] = right->children[i];
+                    left->counts[left->n + 1 + i] = right->counts[i];
+                }
+            }
+        }
+        left->n = total;
+        delete right;
+        grew = false;
+        return left;
+    }
+
+    vector<int> keys;
+    vector<BTreeNode *> children;
+    if (left)
+    {
+        keys.insert(keys.end(), left->keys, left->keys + left->n);
+        if (!leaf)
+        {
+            children.insert(children.end(), left->children, left->children + left->n + 1);
+        }
+    }
+    keys.push_back(key);
+    if (right)
+    {
+        keys.insert(keys.end(), right->keys, right->keys + right->n);
+        if (!leaf)
+        {
+            children.insert(children.end(), right->children, right->children + right->n + 1);
+        }
+    }
+    delete left;
+    delete right;
+    return pack(keys, children, leaf, grew);
+}
+
+// Join a shorter right fragment into the right spine of left, grew is set if the result is one level taller than left
+BTreeNode *BTree::joinRight(BTreeNode *left, int leftHeight, int key, BTreeNode *right, int rightHeight, bool &grew)
+{
+    if (leftHeight == rightHeight)
+    {
+        return joinEqual(left, key, right, leftHeight == 0, grew);
+    }
+
+    int last = left->n;
+    bool childGrew;
+    BTreeNode *child = joinRight(left->children[last], leftHeight - 1, key, right, rightHeight, childGrew);
+    if (!childGrew)
+    {
+        left->children[last] = child;
+        left->counts[last] = child->size();
+        grew = false;
+        return left;
+    }
+
+    // the child was split in two, its middle key and both halves move up into left
+    if (left->n < 2 * t - 1)
+    {
+        left->keys[last] = child->keys[0];
+        for (int i = 0; i < 2; i++)
+        {
+            left->children[last + i] = child->children[i];
+            left->counts[last + i] = child->counts[i];
+        }
+        left->n++;
+        delete child;
+        grew = false;
+        return left;
+    }
+    vector<int> keys(left->keys, left->keys + left->n);
+    vector<BTreeNode *> children(left->children, left->children + last);
+    keys.push_back(child->keys[0]);
+    children.push_back(child->children[0]);
+    children.push_back(child->children[1]);
+    delete child;
+    delete left;
+    return pack(keys, children, false, grew);
+}
+
+// Join a shorter left fragment into the left spine of right, grew is set if the result is one level taller than right
+BTreeNode *BTree::joinLeft(BTreeNode *left, int leftHeight, int key, BTreeNode *right, int rightHeight, bool &grew)
+{
+    if (leftHeight == rightHeight)
+    {
+        return joinEqual(left, key, right, rightHeight == 0, grew);
+    }
+
+    bool childGrew;
+    BTreeNode *child = joinLeft(left, leftHeight, key, right->children[0], rightHeight - 1, childGrew);
+    if (!childGrew)
+    {
+        right->children[0] = child;
+        right->counts[0] = child->size();
+        grew = false;
+        return right;
+    }
+
+    // the child was split in two, its middle key and both halves move up into right
+    if (right->n < 2 * t - 1)
+    {
+        for (int i = right->n; i > 0; i--)
+        {
+            right->keys[i] = right->keys[i - 1];
+            right->children[i + 1] = right->children[i];
+            right->counts[i + 1] = right->counts[i];
+        }
+        right->keys[0] = child->keys[0];
+        for (int i = 0; i < 2; i++)
+        {
+            right->children[i] = child->children[i];
+            right->counts[i] = child->counts[i];
+        }
+        right->n++;
+        delete child;
+        grew = false;
+        return right;
+    }
+    vector<int> keys(1, child->keys[0]);
+    vector<BTreeNode *> children(child->children, child->children + 2);
+    keys.insert(keys.end(), right->keys, right->keys + right->n);
+    children.insert(children.end(), right->children + 1, right->children + right->n + 1);
+    delete child;
+    delete right;
+    return pack(keys, children, false, grew);
+}
+
+// Join two fragments around a key, every key in left <= key <= every key in right
+// Only the spine of the taller fragment down to the height of the shorter one is touched
+BTreeNode *BTree::join(BTreeNode *left, int leftHeight, int key, BTreeNode *right, int rightHeight, int &height)
+{
+    // a missing side is treated as an empty leaf, the key then lands at the end of the other fragment's leaf level
+    if (!left)
+    {
+        leftHeight = 0;
+    }
+    if (!right)
+    {
+        rightHeight = 0;
+    }
+
+    bool grew;
+    BTreeNode *node;
+    if (leftHeight >= rightHeight)
+    {
+        node = joinRight(left, leftHeight, key, right, rightHeight, grew);
+    }
+    else
+    {
+        node = joinLeft(left, leftHeight, key, right, rightHeight, grew);
+    }
+    height = max(leftHeight, rightHeight) + (grew ? 1 : 0);
+    return node;
+}
+
+// Join two fragments without a key between them, the largest key of left is taken out and used instead
+BTreeNode *BTree::join(BTreeNode *left, int leftHeight, BTreeNode *right, int rightHeight)
+{
+    if (!left)
+    {
+        return right;
+    }
+    if (!right)
+    {
+        return left;
+    }
+
+    BTreeNode *cur = left;
+    while (!cur->leaf)
+    {
+        cur = cur->children[cur->n];
+    }
+    int key = cur->keys[cur->n - 1];
+    left->remove(key);
+
+    if (left->n == 0)
+    {
+        BTreeNode *temp = left;
+        left = left->leaf ? nullptr : left->children[0];
+        leftHeight--;
+        delete temp;
+    }
+
+    int height;
+    return join(left, leftHeight, key, right, rightHeight, height);
+}
+
+// Split a fragment into the keys below key (left) and the rest (right), inclusive also sends keys equal to key left
+// The node on the path is cut in two, and each side is joined back with the fragments split off below it
+void BTree::split(BTreeNode *node, int height, int key, bool inclusive, BTreeNode *&left, int &leftHeight, BTreeNode *&right, int &rightHeight)
+{
+    int n = node->n;
+    int i = 0;
+    while (i < n && (inclusive ? node->keys[i] <= key : node->keys[i] < key))
+    {
+        i++;
+    }
+
+    // keys[i + 1, n) and children[i + 1, n] stay right of the path, they move to a new node
+    BTreeNode *rightPart = nullptr;
+    int rightPartHeight = height - 1;
+    int first = node->leaf ? i : i + 1;
+    if (node->leaf ? i < n : i < n - 1)
+    {
+        rightPart = new BTreeNode(t, node->leaf);
+        rightPart->n = n - first;
+        for (int j = first; j < n; j++)
+        {
+            rightPart->keys[j - first] = node->keys[j];
+        }
+        if (!node->leaf)
+        {
+            for (int j = first; j <= n; j++)
+            {
+                rightPart->children[j - first] = node->children[j];
+                rightPart->counts[j - first] = node->counts[j];
+            }
+        }
+        rightPartHeight = height;
+    }
+    else if (!node->leaf && i == n - 1)
+    {
+        rightPart = node->children[n]; // no keys are left on the right, only the last child
+    }
+
+    if (node->leaf)
+    {
+        // keys[0, i) stay in the node
+        node->n = i;
+        left = node;
+        leftHeight = 0;
+        if (i == 0)
+        {
+            delete node;
+            left = nullptr;
+            leftHeight = -1;
+        }
+        right = rightPart;
+        rightHeight = right ? 0 : -1;
+        return;
+    }
+
+    BTreeNode *childLeft, *childRight;
+    int childLeftHeight, childRightHeight;
+    split(node->children[i], height - 1, key, inclusive, childLeft, childLeftHeight, childRight, childRightHeight);
+
+    // keys[i - 1] and keys[i] join the parts left and right of the path to what came up from below
+    int leftKey = i > 0 ? node->keys[i - 1] : 0;
+    int rightKey = i < n ? node->keys[i] : 0;
+
+    // keys[0, i - 1) and children[0, i) stay left of the path, in the node itself
+    BTreeNode *leftPart = node;
+    int leftPartHeight = height;
+    if (i <= 1)
+    {
+        leftPart = i == 1 ? node->children[0] : nullptr;
+        leftPartHeight = height - 1;
+        delete node;
+    }
+    else
+    {
+        node->n = i - 1;
+    }
+
+    if (i == 0)
+    {
+        left = childLeft;
+        leftHeight = childLeftHeight;
+    }
+    else
+    {
+        left = join(leftPart, leftPartHeight, leftKey, childLeft, childLeftHeight, leftHeight);
+    }
+
+    if (i == n)
+    {
+        right = childRight;
+        rightHeight = childRightHeight;
+    }
+    else
+    {
+        right = join(childRight, childRightHeight, rightKey, rightPart, rightPartHeight, rightHeight);
+    }
+}
+
+// Remove every key in [lo, hi], duplicates included, and return the number of keys removed
+// The tree is split at both ends of the range, the middle is freed whole and the two outer fragments are joined back,
+// so only the two boundary paths are rebuilt and nothing is printed for keys that are not there
+int BTree::eraseRange(int lo, int hi)
+{
+    clearFinger();
+
+    if (!root || lo > hi)
+    {
+        return 0;
+    }
+
+    BTreeNode *left, *rest, *inside = nullptr, *right = nullptr;
+    int leftHeight, restHeight, insideHeight, rightHeight = -1;
+    split(root, height(), lo, false, left, leftHeight, rest, restHeight);
+    if (rest)
+    {
+        split(rest, restHeight, hi, true, inside, insideHeight, right, rightHeight);
+    }
+
+    int erased = inside ? inside->size() : 0;
+    destroy(inside);
+    root = join(left, leftHeight, right, rightHeight);
+    return erased;
+}
+
+// Remove a whole batch of keys at once, duplicates included, and return the number of keys removed
+// Long runs of consecutive keys are removed as one range, the keys of short runs one at a time
+int BTree::eraseMany(const vector<int> &keys)
+{
+    if (!is_sorted(keys.begin(), keys.end()))
+    {
+        vector<int> sorted = keys;
+        parallelSort(sorted.begin(), sorted.end(), less<int>());
+        return eraseMany(sorted);
+    }
+
+    clearFinger();
+
+    int erased = 0;
+    for (int first = 0, last; first < (int)keys.size(); first = last)
+    {
+        last = runEnd(keys, first);
+        if ((long long)keys[last - 1] - keys[first] + 1 >= RANGE_ERASE_MIN_RUN)
+        {
+            erased += eraseRange(keys[first], keys[last - 1]);
+            continue;
+        }
+        for (int i = first; i < last; i++)
+        {
+            if (i > first && keys[i] == keys[i - 1])
+            {
+                continue; // every copy is already gone
+            }
+            while (removeKey(keys[i]))
+            {
+                erased++;
+                if (!search(keys[i]))
+                {
+                    break; // a failed remove costs as much as a successful one, a search is cheaper
+                }
+            }
+        }
+    }
+    return erased;
+}
+
+#endif
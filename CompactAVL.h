@@ -0,0 +1,226 @@
+#ifndef COMPACT_AVL_H
+#define COMPACT_AVL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+using namespace std;
+
+const uint32_t NO_NODE = 0xFFFFFFFF; // index used in place of a null child
+
+// hot part of a node in a Compact AVL Tree, only what a search touches
+// 16 bytes, so four nodes share a cache line instead of one AVLNode spanning two
+struct CompactAVLNode
+{
+    int id;
+    uint32_t left;  // index of the left child in the node array
+    uint32_t right; // index of the right child in the node array
+    uint8_t height; // a tree of 2^32 nodes is never taller than 46
+
+    CompactAVLNode(int id)
+        : id(id), left(NO_NODE), right(NO_NODE), height(1) {}
+};
+
+// AVL Tree whose nodes live in one contiguous array and point at each other with 32-bit indices
+// the cold payload (name and age) is kept in separate arrays at the same index
+class CompactAVL
+{
+private:
+    vector<CompactAVLNode> nodes; // hot keys and links
+    vector<string> names;         // cold payload, names[i] belongs to nodes[i]
+    vector<int> ages;             // cold payload, ages[i] belongs to nodes[i]
+    vector<uint32_t> freeSlots;   // slots of removed nodes, reused before the arrays grow
+    uint32_t root;                // index of the root node
+
+    int getHeight(uint32_t node)
+    {
+        return node != NO_NODE ? nodes[node].height : 0; // if node is not null then return the height of the node otherwise return 0
+    }
+
+    int getBalanceFactor(uint32_t node)
+    {
+        return node != NO_NODE ? getHeight(nodes[node].left) - getHeight(nodes[node].right) : 0; // difference of height of left and right children of the node
+    }
+
+    void updateHeight(uint32_t node)
+    {
+        nodes[node].height = max(getHeight(nodes[node].left), getHeight(nodes[node].right)) + 1;
+    }
+
+    uint32_t allocate(int id, string_view name, int age)
+    {
+        if (!freeSlots.empty())
+        {
+            // reuse the slot of a removed node
+            uint32_t slot = freeSlots.back();
+            freeSlots.pop_back();
+            nodes[slot] = CompactAVLNode(id);
+            names[slot] = name;
+            ages[slot] = age;
+            return slot;
+        }
+        nodes.emplace_back(id);
+        names.emplace_back(name);
+        ages.push_back(age);
+        return nodes.size() - 1;
+    }
+
+    void release(uint32_t node)
+    {
+        names[node].clear(); // drop the payload now, the slot itself is reused later
+        freeSlots.push_back(node);
+    }
+
+    uint32_t rotateRight(uint32_t y)
+    {
+        uint32_t x = nodes[y].left;     // x is the left child of y
+        uint32_t temp = nodes[x].right; // temp is the right child of x
+
+        nodes[x].right = y;   // make y the right child of x
+        nodes[y].left = temp; // make temp the left child of y
+
+        updateHeight(y);
+        updateHeight(x);
+
+        return x; // return the new root
+    }
+
+    uint32_t rotateLeft(uint32_t x)
+    {
+        uint32_t y = nodes[x].right;   // y is the right child of x
+        uint32_t temp = nodes[y].left; // temp is the left child of y
+
+        nodes[y].left = x;     // make x the left child of y
+        nodes[x].right = temp; // make temp the right child of x
+
+        updateHeight(x);
+        updateHeight(y);
+
+        return y; // return the new root
+    }
+
+    uint32_t rebalance(uint32_t node)
+    {
+        updateHeight(node);
+
+        int balance = getBalanceFactor(node);
+
+        if (balance > 1)
+        {
+            if (getBalanceFactor(nodes[node].left) < 0)
+            {
+                nodes[node].left = rotateLeft(nodes[node].left); // Left-Right case
+            }
+            return rotateRight(node); // Left-Left case
+        }
+        if (balance < -1)
+        {
+            if (getBalanceFactor(nodes[node].right) > 0)
+            {
+                nodes[node].right = rotateRight(nodes[node].right); // Right-Left case
+            }
+            return rotateLeft(node); // Right-Right case
+        }
+        return node;
+    }
+
+    // indices stay valid when the arrays grow, so only indices are kept across the recursive calls
+    uint32_t insert(uint32_t node, int id, string_view name, int age)
+    {
+        if (node == NO_NODE)
+        {
+            return allocate(id, name, age); // if node is null then create a new node
+        }
+        if (id < nodes[node].id)
+        {
+            uint32_t child = insert(nodes[node].left, id, name, age);
+            nodes[node].left = child;
+        }
+        else if (id > nodes[node].id)
+        {
+            uint32_t child = insert(nodes[node].right, id, name, age);
+            nodes[node].right = child;
+        }
+        else
+            return node; // Duplicate IDs not allowed
+
+        return rebalance(node);
+    }
+
+    uint32_t deleteNode(uint32_t node, int id)
+    {
+        if (node == NO_NODE)
+        {
+            return node;
+        }
+        if (id < nodes[node].id)
+        {
+            nodes[node].left = deleteNode(nodes[node].left, id);
+        }
+        else if (id > nodes[node].id)
+        {
+            nodes[node].right = deleteNode(nodes[node].right, id);
+        }
+        else
+        {
+            if (nodes[node].left == NO_NODE || nodes[node].right == NO_NODE)
+            {
+                // no child or only one child, that child takes the place of the node
+                uint32_t child = nodes[node].left != NO_NODE ? nodes[node].left : nodes[node].right;
+                release(node);
+                return child;
+            }
+
+            // find the inorder successor and copy its data to this node
+            uint32_t successor = nodes[node].right;
+            while (nodes[successor].left != NO_NODE)
+            {
+                successor = nodes[successor].left;
+            }
+            nodes[node].id = nodes[successor].id;
+            names[node] = move(names[successor]);
+            ages[node] = ages[successor];
+
+            nodes[node].right = deleteNode(nodes[node].right, nodes[node].id); // delete the inorder successor
+        }
+
+        return rebalance(node);
+    }
+
+public:
+    CompactAVL() : root(NO_NODE) {}
+
+    // reserve room for n nodes so that inserting them never moves the arrays
+    void reserve(int n)
+    {
+        nodes.reserve(n);
+        names.reserve(n);
+        ages.reserve(n);
+    }
+
+    void insert(int id, string_view name, int age)
+    {
+        // insert the data
+        root = insert(root, id, name, age);
+    }
+
+    void remove(int id)
+    {
+        // delete the data
+        root = deleteNode(root, id);
+    }
+
+    bool search(int id)
+    {
+        // only the hot array is touched while walking down
+        uint32_t node = root;
+        while (node != NO_NODE && nodes[node].id != id)
+        {
+            node = id < nodes[node].id ? nodes[node].left : nodes[node].right;
+        }
+        return node != NO_NODE;
+    }
+};
+
+#endif
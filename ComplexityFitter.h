@@ -0,0 +1,211 @@
+#ifndef COMPLEXITY_FITTER_H
+#define COMPLEXITY_FITTER_H
+
+#include <cmath>
+#include <vector>
+using namespace std;
+
+// complexity classes the measurements are fitted against, from slowest growing to fastest growing
+enum ComplexityClass
+{
+    CONSTANT,
+    LOGARITHMIC,
+    LINEAR,
+    LINEARITHMIC,
+    QUADRATIC
+};
+
+const int COMPLEXITY_CLASSES = 5;
+
+inline const char *complexityName(ComplexityClass c)
+{
+    switch (c)
+    {
+    case CONSTANT:
+        return "O(1)";
+    case LOGARITHMIC:
+        return "O(log n)";
+    case LINEAR:
+        return "O(n)";
+    case LINEARITHMIC:
+        return "O(n log n)";
+    default:
+        return "O(n^2)";
+    }
+}
+
+// the term of the class the fitted constant multiplies
+inline const char *complexityTerm(ComplexityClass c)
+{
+    switch (c)
+    {
+    case CONSTANT:
+        return "1";
+    case LOGARITHMIC:
+        return "log n";
+    case LINEAR:
+        return "n";
+    case LINEARITHMIC:
+        return "n log n";
+    default:
+        return "n^2";
+    }
+}
+
+// value of the model f(n) of a complexity class
+inline double complexityModel(ComplexityClass c, double n)
+{
+    switch (c)
+    {
+    case CONSTANT:
+        return 1;
+    case LOGARITHMIC:
+        return log2(n);
+    case LINEAR:
+        return n;
+    case LINEARITHMIC:
+        return n * log2(n);
+    default:
+        return n * n;
+    }
+}
+
+// a more complex class has to cut the relative error by at least this factor to be preferred over a simpler one
+// noise alone rarely halves it, a real change of class does by far
+const double COMPLEXITY_MARGIN = 0.5;
+
+// how far the log-log slope of the measurements may exceed the slope of the expected class
+// cache and TLB misses grow with n too and lift a logarithmic search to a slope of about 0.5,
+// while a search that has turned linear has a slope close to 1
+const double COMPLEXITY_SLOPE_MARGIN = 0.6;
+
+// result of fitting time(n) = a + b * f(n)
+struct ComplexityFit
+{
+    ComplexityClass complexity; // class whose model fits best
+    double a;                   // fixed cost per operation, in the unit of the measured times
+    double b;                   // cost per unit of f(n), in the unit of the measured times
+    double rSquared;            // goodness of fit with the weights of the fit, 1 is a perfect fit
+    double relativeError;       // root mean square of the relative residuals, used to pick the best class
+    double slope;               // log-log slope of the measurements, 1 for linear growth and close to 0 for logarithmic
+};
+
+// least squares slope of log(time) against log(n)
+inline double logLogSlope(const vector<double> &sizes, const vector<double> &times)
+{
+    int count = sizes.size();
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double x = log(sizes[i]);
+        double y = log(times[i]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+    }
+    double determinant = count * sxx - sx * sx;
+    return determinant > 0 ? (count * sxy - sx * sy) / determinant : 0;
+}
+
+// log-log slope the model of a class has over the given sizes, e.g. about 0.1 for log n between 1000 and 500000
+inline double modelSlope(ComplexityClass c, const vector<double> &sizes)
+{
+    vector<double> model;
+    for (double n : sizes)
+    {
+        model.push_back(complexityModel(c, n));
+    }
+    return logLogSlope(sizes, model);
+}
+
+// fit time(n) = a + b * f(n) for one class, with a and b kept non-negative
+// residuals are weighted by 1 / time^2, so small sizes count as much as large ones
+inline ComplexityFit fitModel(ComplexityClass c, const vector<double> &sizes, const vector<double> &times)
+{
+    int count = sizes.size();
+
+    // sums of the weighted normal equations
+    double s = 0, sf = 0, sff = 0, sy = 0, sfy = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double w = 1 / (times[i] * times[i]);
+        double f = complexityModel(c, sizes[i]);
+        s += w;
+        sf += w * f;
+        sff += w * f * f;
+        sy += w * times[i];
+        sfy += w * f * times[i];
+    }
+
+    double a, b;
+    double determinant = s * sff - sf * sf;
+    if (c == CONSTANT || determinant <= 0)
+    {
+        a = sy / s; // a flat model only has the fixed cost
+        b = 0;
+    }
+    else
+    {
+        b = (s * sfy - sf * sy) / determinant;
+        a = (sy - b * sf) / s;
+        if (b < 0)
+        {
+            b = 0; // times that fall with n are fitted by the fixed cost alone
+            a = sy / s;
+        }
+        else if (a < 0)
+        {
+            a = 0; // no negative fixed cost, the whole time is put on f(n)
+            b = sfy / sff;
+        }
+    }
+
+    // R^2 against the weighted mean, with the weights of the fit, so it never drops below the flat model
+    double mean = sy / s;
+    double squaredResiduals = 0, squaredTotal = 0, squaredRelative = 0;
+    for (int i = 0; i < count; i++)
+    {
+        double w = 1 / (times[i] * times[i]);
+        double residual = times[i] - (a + b * complexityModel(c, sizes[i]));
+        squaredResiduals += w * residual * residual;
+        squaredTotal += w * (times[i] - mean) * (times[i] - mean);
+        squaredRelative += (residual / times[i]) * (residual / times[i]);
+    }
+
+    ComplexityFit fit;
+    fit.complexity = c;
+    fit.a = a;
+    fit.b = b;
+    fit.rSquared = squaredTotal > 0 ? 1 - squaredResiduals / squaredTotal : 1; // flat measurements are fitted exactly by O(1)
+    fit.relativeError = sqrt(squaredRelative / count);
+    fit.slope = logLogSlope(sizes, times);
+    return fit;
+}
+
+// fit every class and return the best one
+// going from simple to complex, a class only wins if it clearly beats the best simpler class
+// times must be positive, sizes and times must have the same length
+inline ComplexityFit fitComplexity(const vector<double> &sizes, const vector<double> &times)
+{
+    ComplexityFit best = fitModel(CONSTANT, sizes, times);
+    for (int c = 1; c < COMPLEXITY_CLASSES; c++)
+    {
+        ComplexityFit fit = fitModel((ComplexityClass)c, sizes, times);
+        if (fit.relativeError < best.relativeError * COMPLEXITY_MARGIN)
+        {
+            best = fit;
+        }
+    }
+    return best;
+}
+
+// whether the measurements grow faster than the expected class allows
+// both tests have to agree: a faster class has to win the fit, and the times have to rise clearly steeper than the
+// expected class does over the same sizes, so cache misses piling up on a healthy tree are not reported
+inline bool growsFasterThan(const ComplexityFit &fit, ComplexityClass expected, const vector<double> &sizes)
+{
+    return fit.complexity > expected && fit.slope > modelSlope(expected, sizes) + COMPLEXITY_SLOPE_MARGIN;
+}
+
+#endif
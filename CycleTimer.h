@@ -0,0 +1,193 @@
+#ifndef CYCLE_TIMER_H
+#define CYCLE_TIMER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+using namespace std;
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define CYCLE_TIMER_HAS_TSC 1
+#else
+#define CYCLE_TIMER_HAS_TSC 0
+#endif
+
+const int CALIBRATION_MS = 20;    // how long the counter is compared against the steady clock at startup
+const int OVERHEAD_ROUNDS = 1000; // empty start/stop pairs used to measure the timer's own cost
+
+// Timer for single operations, backed by the invariant time stamp counter when the CPU has one
+// Falls back to the steady clock (one tick per nanosecond) everywhere else
+class CycleTimer
+{
+private:
+    bool useTsc;       // true if the time stamp counter is used
+    double nsPerTick;  // calibrated length of one tick
+    uint64_t overhead; // ticks measured by an empty start/stop pair
+
+    static uint64_t clockTicks()
+    {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // the counter only measures time if it runs at a constant rate in every power state
+    static bool hasInvariantTsc()
+    {
+#if CYCLE_TIMER_HAS_TSC
+        unsigned eax, ebx, ecx, edx;
+        if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) && eax >= 0x80000007 &&
+            __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+        {
+            return (edx & (1 << 8)) != 0; // Advanced Power Management: invariant TSC bit
+        }
+#endif
+        return false;
+    }
+
+    void calibrate()
+    {
+        nsPerTick = 1;
+        if (useTsc)
+        {
+            // count ticks across a fixed stretch of steady clock time
+            uint64_t clockBegin = clockTicks();
+            uint64_t tickBegin = start();
+            while (clockTicks() - clockBegin < CALIBRATION_MS * 1000000ULL)
+            {
+            }
+            uint64_t tickEnd = stop();
+            uint64_t clockEnd = clockTicks();
+            nsPerTick = double(clockEnd - clockBegin) / double(tickEnd - tickBegin);
+        }
+
+        // the cheapest empty measurement is the cost every real measurement pays on top
+        overhead = UINT64_MAX;
+        for (int i = 0; i < OVERHEAD_ROUNDS; i++)
+        {
+            uint64_t begin = start();
+            uint64_t end = stop();
+            overhead = min(overhead, end - begin);
+        }
+    }
+
+public:
+    CycleTimer()
+    {
+        useTsc = hasInvariantTsc();
+        calibrate();
+    }
+
+    // read the counter before the measured code, the fences keep earlier instructions from leaking in
+    uint64_t start()
+    {
+#if CYCLE_TIMER_HAS_TSC
+        if (useTsc)
+        {
+            _mm_lfence();
+            uint64_t ticks = __rdtsc();
+            _mm_lfence();
+            return ticks;
+        }
+#endif
+        return clockTicks();
+    }
+
+    // read the counter after the measured code, rdtscp waits for it to finish and the fence keeps later code out
+    uint64_t stop()
+    {
+#if CYCLE_TIMER_HAS_TSC
+        if (useTsc)
+        {
+            unsigned aux;
+            uint64_t ticks = __rdtscp(&aux);
+            _mm_lfence();
+            return ticks;
+        }
+#endif
+        return clockTicks();
+    }
+
+    // nanoseconds between a start and a stop reading, with the timer's own overhead taken out
+    double elapsed(uint64_t begin, uint64_t end)
+    {
+        uint64_t ticks = end - begin;
+        return ticks > overhead ? (ticks - overhead) * nsPerTick : 0;
+    }
+
+    bool usesTsc()
+    {
+        return useTsc;
+    }
+
+    // ticks per nanosecond, i.e. the counter frequency in GHz
+    double frequencyGHz()
+    {
+        return 1 / nsPerTick;
+    }
+
+    double overheadNs()
+    {
+        return overhead * nsPerTick;
+    }
+};
+
+// Times one operation out of every rate operations, the rest run untimed
+// so that reading the counter does not distort the loop being measured
+class OperationSampler
+{
+private:
+    CycleTimer &timer;
+    int rate;               // one operation in rate is timed
+    long long operations;   // operations run so far
+    vector<double> samples; // nanoseconds of every timed operation
+
+public:
+    OperationSampler(CycleTimer &timer, int rate)
+        : timer(timer), rate(rate > 0 ? rate : 1), operations(0) {}
+
+    template <typename Operation>
+    void run(Operation operation)
+    {
+        if (operations++ % rate != 0)
+        {
+            operation();
+            return;
+        }
+        uint64_t begin = timer.start();
+        operation();
+        uint64_t end = timer.stop();
+        samples.push_back(timer.elapsed(begin, end));
+    }
+
+    int count()
+    {
+        return samples.size();
+    }
+
+    double mean()
+    {
+        double total = 0;
+        for (double sample : samples)
+        {
+            total += sample;
+        }
+        return samples.empty() ? 0 : total / samples.size();
+    }
+
+    // the sample below which the given fraction of samples lie, e.g. 0.5 for the median
+    double percentile(double fraction)
+    {
+        if (samples.empty())
+        {
+            return 0;
+        }
+        vector<double> sorted = samples;
+        int index = min((int)(fraction * sorted.size()), (int)sorted.size() - 1);
+        nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+        return sorted[index];
+    }
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef DATASET_H
+#define DATASET_H
+
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Parallel.h"
+#include "Record.h"
+using namespace std;
+
+// Records of a benchmark run stored column by column, generated once before anything is timed
+// Record i has id i, so ids[i], ages[i] and name(i) can be reached from the id alone
+// The names are packed back to back in one buffer, so the whole dataset is three allocations and not one per name
+struct Dataset
+{
+    vector<int> ids;            // id column
+    vector<int> ages;           // age column
+    string nameBytes;           // name column, every name is formatted up front
+    vector<size_t> nameOffsets; // name i is nameBytes[nameOffsets[i], nameOffsets[i + 1])
+
+    Dataset(int size, int threads = threadBudget())
+        : ids(size), ages(size), nameOffsets(size + 1)
+    {
+        // every name is the prefix and the decimal digits of i + 1, so the offsets follow from the lengths alone
+        const string prefix = "Name: alpha_";
+        long long nextPower = 10; // smallest number with one more digit than i + 1
+        size_t digits = 1;
+        nameOffsets[0] = 0;
+        for (int i = 0; i < size; i++)
+        {
+            if (i + 1 == nextPower)
+            {
+                digits++;
+                nextPower *= 10;
+            }
+            nameOffsets[i + 1] = nameOffsets[i] + prefix.size() + digits;
+        }
+        nameBytes.resize(nameOffsets[size]);
+
+        // every thread fills its own slice of the three columns
+        vector<thread> workers;
+        for (int t = 0; t < threads; t++)
+        {
+            int begin = (long long)size * t / threads;
+            int end = (long long)size * (t + 1) / threads;
+            workers.emplace_back([this, &prefix, begin, end]()
+                                 {
+                for (int i = begin; i < end; i++)
+                {
+                    ids[i] = i;
+                    ages[i] = i % 100;
+                    char *name = &nameBytes[nameOffsets[i]];
+                    memcpy(name, prefix.data(), prefix.size());
+                    to_chars(name + prefix.size(), &nameBytes[0] + nameOffsets[i + 1], i + 1);
+                } });
+        }
+        for (thread &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // name of record id, a view into the name column
+    string_view name(int id) const
+    {
+        return string_view(nameBytes.data() + nameOffsets[id], nameOffsets[id + 1] - nameOffsets[id]);
+    }
+
+    int size() const
+    {
+        return ids.size();
+    }
+
+    // rows for the given ids, in the given order, for the bulk operations that take whole records
+    vector<Record> records(const vector<int> &order) const
+    {
+        vector<Record> rows;
+        rows.reserve(order.size());
+        for (int id : order)
+        {
+            rows.emplace_back(ids[id], string(name(id)), ages[id]);
+        }
+        return rows;
+    }
+};
+
+#endif
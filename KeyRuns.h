@@ -0,0 +1,32 @@
+#ifndef KEY_RUNS_H
+#define KEY_RUNS_H
+
+#include <vector>
+using namespace std;
+
+// A run is a stretch of a sorted key list in which every key is equal to or one above the key before it,
+// so the whole stretch can be erased as one range instead of key by key
+// The runs are found in place, a batch of millions of keys needs no second list
+
+// index one past the end of the run that holds sortedKeys[i]
+inline int runEnd(const vector<int> &sortedKeys, int i)
+{
+    int size = sortedKeys.size();
+    while (i + 1 < size && sortedKeys[i + 1] <= (long long)sortedKeys[i] + 1)
+    {
+        i++;
+    }
+    return i + 1;
+}
+
+// index of the first key of the run that holds sortedKeys[i]
+inline int runBegin(const vector<int> &sortedKeys, int i)
+{
+    while (i > 0 && sortedKeys[i] <= (long long)sortedKeys[i - 1] + 1)
+    {
+        i--;
+    }
+    return i;
+}
+
+#endif
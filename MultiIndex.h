@@ -0,0 +1,87 @@
+#ifndef MULTI_INDEX_H
+#define MULTI_INDEX_H
+
+#include <climits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "AVL.h"
+using namespace std;
+
+// Multi-Index: records stored once in an AVL Tree on id, with a secondary AVL Tree on (age, id)
+// The age alone is not unique, so it is paired with the id to make a composite key
+// Both indexes are updated together on every insert and remove, so a query by age never has to scan the records
+class MultiIndex
+{
+private:
+    AVL primary;                            // records by id
+    BasicAVL<pair<int, int>, KeyOnly> ages; // (age, id) of every record, ordered by age and then by id, nothing else
+
+public:
+    void insert(int id, string_view name, int age)
+    {
+        int before = primary.size();
+        primary.insert(id, name, age);
+        if (primary.size() != before)
+        {
+            ages.insert(make_pair(age, id)); // a duplicate id is ignored by the primary tree, so it is not indexed either
+        }
+    }
+
+    void remove(int id)
+    {
+        AVLNode *record = primary.find(id);
+        if (!record)
+        {
+            return;
+        }
+        ages.remove(make_pair(record->age, id)); // the age has to be read before the record is gone
+        primary.remove(id);
+    }
+
+    bool search(int id)
+    {
+        return primary.search(id);
+    }
+
+    // the record with the given id, nullptr if there is none
+    AVLNode *find(int id)
+    {
+        return primary.find(id);
+    }
+
+    int size()
+    {
+        return primary.size();
+    }
+
+    // ids of the records with the given age, in increasing order
+    vector<int> findByAge(int age)
+    {
+        return ageRange(age, age);
+    }
+
+    // ids of the records with lo <= age <= hi, ordered by age and then by id
+    vector<int> ageRange(int lo, int hi)
+    {
+        vector<int> ids;
+        if (lo > hi)
+        {
+            return ids;
+        }
+        pair<int, int> first = make_pair(lo, INT_MIN), last = make_pair(hi, INT_MAX);
+        ids.reserve(ages.countRange(first, last));
+        ages.forRange(first, last, [&ids](BasicAVLNode<pair<int, int>, KeyOnly> *node)
+                      { ids.push_back(node->id.second); });
+        return ids;
+    }
+
+    // number of records with lo <= age <= hi, without visiting them
+    int countAgeRange(int lo, int hi)
+    {
+        return ages.countRange(make_pair(lo, INT_MIN), make_pair(hi, INT_MAX));
+    }
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <thread>
+using namespace std;
+
+// below this many elements a range is sorted on the current thread, splitting it further costs more than it saves
+const int PARALLEL_CUTOFF = 10000;
+
+// number of threads the fork-join helpers are allowed to use
+inline int threadBudget()
+{
+    int cores = thread::hardware_concurrency();
+    return cores > 0 ? cores : 1; // hardware_concurrency() may return 0 if it cannot tell
+}
+
+// run left and right, splitting the thread budget between them
+// left runs on a new thread only if there is more than one thread to spend
+template <typename Left, typename Right>
+void forkJoin(int threads, Left left, Right right)
+{
+    if (threads <= 1)
+    {
+        left(1);
+        right(1);
+        return;
+    }
+    thread worker(left, threads / 2); // left half of the budget goes to the new thread
+    right(threads - threads / 2);     // the current thread keeps the rest
+    worker.join();
+}
+
+// stable merge sort of [first, last), the two halves are sorted in parallel and then merged
+template <typename Iterator, typename Compare>
+void parallelSort(Iterator first, Iterator last, Compare comp, int threads = threadBudget())
+{
+    if (threads <= 1 || last - first < PARALLEL_CUTOFF)
+    {
+        stable_sort(first, last, comp);
+        return;
+    }
+    Iterator middle = first + (last - first) / 2;
+    forkJoin(
+        threads,
+        [&](int budget)
+        { parallelSort(first, middle, comp, budget); },
+        [&](int budget)
+        { parallelSort(middle, last, comp, budget); });
+    inplace_merge(first, middle, last, comp);
+}
+
+#endif
@@ -0,0 +1,445 @@
+#ifndef PERSISTENT_AVL_H
+#define PERSISTENT_AVL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include "Record.h"
+using namespace std;
+
+const int MAX_READERS = 64;      // reader slots, every reader thread uses its own
+const int RECLAIM_INTERVAL = 64; // writes between two attempts to free retired nodes
+
+// structure for Node of a Persistent AVL Tree
+// A node is never changed once a version that contains it is published, a write copies it instead
+// The record is shared by every copy of the node, so copying a path never copies names
+struct PersistentAVLNode
+{
+    int id;
+    int height;
+    int size;             // number of nodes in the subtree rooted here
+    uint64_t version;     // write that created the node, only nodes of the current write may be changed in place
+    const Record *record; // id, name and age, shared with the copies of this node in other versions
+    PersistentAVLNode *left;
+    PersistentAVLNode *right;
+
+    PersistentAVLNode(const Record *record, uint64_t version)
+        : id(record->id), height(1), size(1), version(version), record(record), left(nullptr), right(nullptr) {}
+};
+
+// nodes and records unlinked by one write, freed once no reader can still be inside the version they belonged to
+// The pointers themselves wait in two queues shared by all writes, a batch only counts its share of them
+struct RetiredBatch
+{
+    uint64_t epoch; // global epoch when the write was published
+    int nodes;      // nodes the write retired
+    int records;    // records the write retired
+};
+
+// epoch a reader announced when it pinned a version, alone on its cache line so readers never share one
+struct alignas(64) ReaderSlot
+{
+    atomic<uint64_t> epoch; // 0 while the reader is not inside a version
+
+    ReaderSlot() : epoch(0) {}
+};
+
+// Persistent AVL Tree: every insert and remove copies the path it changes and publishes a new root,
+// all other nodes are shared with the previous version
+// One writer, any number of readers: a reader pins the current version and searches it without locks,
+// old nodes are freed by epoch-based reclamation once every reader that could see them has left
+class PersistentAVL
+{
+private:
+    atomic<PersistentAVLNode *> root; // latest published version
+    atomic<uint64_t> globalEpoch;     // advanced by every published write
+    ReaderSlot readers[MAX_READERS];
+
+    uint64_t version;                    // number of the write in progress
+    deque<PersistentAVLNode *> oldNodes; // retired nodes, oldest write first
+    deque<const Record *> oldRecords;    // retired records, oldest write first
+    deque<RetiredBatch> retired;         // one entry per write that retired something
+    RetiredBatch pending;                // what the write in progress unlinks
+    int writes;                          // writes since the last reclamation
+
+    int getHeight(PersistentAVLNode *node)
+    {
+        return node ? node->height : 0; // if node is not null then return the height of the node otherwise return 0
+    }
+
+    int getSize(PersistentAVLNode *node)
+    {
+        return node ? node->size : 0; // if node is not null then return the size of its subtree otherwise return 0
+    }
+
+    int getBalanceFactor(PersistentAVLNode *node)
+    {
+        return node ? getHeight(node->left) - getHeight(node->right) : 0; // difference of height of left and right children of the node
+    }
+
+    void update(PersistentAVLNode *node)
+    {
+        node->height = max(getHeight(node->left), getHeight(node->right)) + 1; // update the height of the node
+        node->size = getSize(node->left) + getSize(node->right) + 1;           // update the size of the node
+    }
+
+    // a node that may be changed in place: nodes of the current write are returned as they are,
+    // published nodes are copied and the original is retired
+    PersistentAVLNode *copy(PersistentAVLNode *node)
+    {
+        if (node->version == version)
+        {
+            return node;
+        }
+        PersistentAVLNode *fresh = new PersistentAVLNode(*node);
+        fresh->version = version;
+        retire(node);
+        return fresh;
+    }
+
+    void retire(PersistentAVLNode *node)
+    {
+        oldNodes.push_back(node);
+        pending.nodes++;
+    }
+
+    // a node that leaves the tree, freed now if no version ever contained it
+    void discard(PersistentAVLNode *node)
+    {
+        if (node->version == version)
+        {
+            delete node;
+        }
+        else
+        {
+            retire(node);
+        }
+    }
+
+    PersistentAVLNode *rotateRight(PersistentAVLNode *y)
+    {
+        PersistentAVLNode *x = copy(y->left); // x is the left child of y
+        PersistentAVLNode *temp = x->right;   // temp is the right child of x, shared as it is
+
+        x->right = y;   // make y the right child of x
+        y->left = temp; // make temp the left child of y
+
+        update(y);
+        update(x);
+
+        return x; // return the new root
+    }
+
+    PersistentAVLNode *rotateLeft(PersistentAVLNode *x)
+    {
+        PersistentAVLNode *y = copy(x->right); // y is the right child of x
+        PersistentAVLNode *temp = y->left;     // temp is the left child of y, shared as it is
+
+        y->left = x;     // make x the left child of y
+        x->right = temp; // make temp the right child of x
+
+        update(x);
+        update(y);
+
+        return y; // return the new root
+    }
+
+    // node must belong to the current write
+    PersistentAVLNode *rebalance(PersistentAVLNode *node)
+    {
+        update(node);
+
+        int balance = getBalanceFactor(node); // get the balance factor of the node
+
+        if (balance > 1)
+        {
+            if (getBalanceFactor(node->left) < 0)
+            {
+                node->left = rotateLeft(copy(node->left)); // Left-Right case
+            }
+            return rotateRight(node); // Left-Left case
+        }
+        if (balance < -1)
+        {
+            if (getBalanceFactor(node->right) > 0)
+            {
+                node->right = rotateRight(copy(node->right)); // Right-Left case
+            }
+            return rotateLeft(node); // Right-Right case
+        }
+        return node;
+    }
+
+    // a subtree that did not change keeps its pointer, so nothing above it is copied either
+    PersistentAVLNode *insert(PersistentAVLNode *node, int id, string_view name, int age)
+    {
+        if (!node)
+        {
+            return new PersistentAVLNode(new Record(id, string(name), age), version); // if node is null then create a new node
+        }
+        if (id < node->id)
+        {
+            PersistentAVLNode *left = insert(node->left, id, name, age);
+            if (left == node->left)
+            {
+                return node;
+            }
+            node = copy(node);
+            node->left = left;
+        }
+        else if (id > node->id)
+        {
+            PersistentAVLNode *right = insert(node->right, id, name, age);
+            if (right == node->right)
+            {
+                return node;
+            }
+            node = copy(node);
+            node->right = right;
+        }
+        else
+            return node; // Duplicate IDs not allowed
+
+        return rebalance(node);
+    }
+
+    // detach the node with the smallest id, which is returned through min
+    PersistentAVLNode *removeMin(PersistentAVLNode *node, PersistentAVLNode *&min)
+    {
+        if (!node->left)
+        {
+            min = node;
+            return node->right;
+        }
+        PersistentAVLNode *left = removeMin(node->left, min);
+        node = copy(node);
+        node->left = left;
+        return rebalance(node);
+    }
+
+    PersistentAVLNode *remove(PersistentAVLNode *node, int id)
+    {
+        if (!node)
+        {
+            return nullptr;
+        }
+        if (id < node->id)
+        {
+            PersistentAVLNode *left = remove(node->left, id);
+            if (left == node->left)
+            {
+                return node; // id is not in the tree
+            }
+            node = copy(node);
+            node->left = left;
+            return rebalance(node);
+        }
+        if (id > node->id)
+        {
+            PersistentAVLNode *right = remove(node->right, id);
+            if (right == node->right)
+            {
+                return node; // id is not in the tree
+            }
+            node = copy(node);
+            node->right = right;
+            return rebalance(node);
+        }
+
+        oldRecords.push_back(node->record);
+        pending.records++;
+        PersistentAVLNode *left = node->left, *right = node->right;
+        discard(node);
+        if (!left || !right)
+        {
+            return left ? left : right; // no child or only one child, that child takes the place of the node
+        }
+
+        // the inorder successor takes the place of the node, its record moves along with it
+        PersistentAVLNode *successor;
+        right = removeMin(right, successor);
+        successor = copy(successor);
+        successor->left = left;
+        successor->right = right;
+        return rebalance(successor);
+    }
+
+    // make the result of the write in progress visible to readers and retire what it unlinked
+    void publish(PersistentAVLNode *newRoot)
+    {
+        root.store(newRoot);
+        pending.epoch = globalEpoch.fetch_add(1); // readers that pin from now on see the new root
+        if (pending.nodes > 0 || pending.records > 0)
+        {
+            retired.push_back(pending);
+        }
+        pending.nodes = pending.records = 0;
+        if (++writes >= RECLAIM_INTERVAL)
+        {
+            reclaim();
+        }
+    }
+
+    // free the oldest batch, its nodes and records are at the front of the queues
+    void free(const RetiredBatch &batch)
+    {
+        for (int i = 0; i < batch.nodes; i++)
+        {
+            delete oldNodes.front();
+            oldNodes.pop_front();
+        }
+        for (int i = 0; i < batch.records; i++)
+        {
+            delete oldRecords.front();
+            oldRecords.pop_front();
+        }
+    }
+
+    void destroy(PersistentAVLNode *node)
+    {
+        if (!node)
+        {
+            return;
+        }
+        destroy(node->left);  // free the left subtree
+        destroy(node->right); // free the right subtree
+        delete node->record;
+        delete node;
+    }
+
+public:
+    PersistentAVL() : root(nullptr), globalEpoch(1), version(0), writes(0)
+    {
+        pending.nodes = pending.records = 0;
+    }
+
+    // no reader may be inside a version any more
+    ~PersistentAVL()
+    {
+        for (PersistentAVLNode *node : oldNodes)
+        {
+            delete node;
+        }
+        for (const Record *record : oldRecords)
+        {
+            delete record;
+        }
+        destroy(root.load());
+    }
+
+    // Writer side: only one thread may call these
+
+    void insert(int id, string_view name, int age)
+    {
+        version++;
+        publish(insert(root.load(), id, name, age));
+    }
+
+    void remove(int id)
+    {
+        version++;
+        publish(remove(root.load(), id));
+    }
+
+    bool search(int id)
+    {
+        return find(root.load(), id) != nullptr; // the writer never frees the version it reads
+    }
+
+    int size()
+    {
+        return getSize(root.load());
+    }
+
+    // free every retired batch that no pinned reader can still reach
+    void reclaim()
+    {
+        writes = 0;
+        uint64_t oldest = UINT64_MAX; // oldest epoch a reader is still inside
+        for (ReaderSlot &slot : readers)
+        {
+            uint64_t epoch = slot.epoch.load();
+            if (epoch != 0 && epoch < oldest)
+            {
+                oldest = epoch;
+            }
+        }
+        while (!retired.empty() && retired.front().epoch < oldest)
+        {
+            free(retired.front());
+            retired.pop_front();
+        }
+    }
+
+    // nodes and records retired but not freed yet
+    long long retiredCount()
+    {
+        return oldNodes.size() + oldRecords.size();
+    }
+
+    // Reader side: reader is a slot number in [0, MAX_READERS) that no other thread uses at the same time
+
+    // announce the current epoch, then read the root: a version published later retires nothing this reader can reach
+    // unless its epoch is newer than the one announced here
+    PersistentAVLNode *pin(int reader)
+    {
+        readers[reader].epoch.store(globalEpoch.load());
+        return root.load();
+    }
+
+    void unpin(int reader)
+    {
+        readers[reader].epoch.store(0, memory_order_release);
+    }
+
+    // the node with the given id in a pinned version, nullptr if there is none
+    static const PersistentAVLNode *find(const PersistentAVLNode *node, int id)
+    {
+        while (node && node->id != id)
+        {
+            node = id < node->id ? node->left : node->right;
+        }
+        return node;
+    }
+};
+
+// A version pinned by one reader for as long as the snapshot lives
+// Every search sees the tree exactly as it was when the snapshot was taken, whatever the writer does meanwhile
+class Snapshot
+{
+private:
+    PersistentAVL &tree;
+    int reader;
+    const PersistentAVLNode *root;
+
+public:
+    Snapshot(PersistentAVL &tree, int reader)
+        : tree(tree), reader(reader), root(tree.pin(reader)) {}
+
+    ~Snapshot()
+    {
+        tree.unpin(reader);
+    }
+
+    bool search(int id)
+    {
+        return PersistentAVL::find(root, id) != nullptr;
+    }
+
+    // the record with the given id, nullptr if there is none
+    const Record *find(int id)
+    {
+        const PersistentAVLNode *node = PersistentAVL::find(root, id);
+        return node ? node->record : nullptr;
+    }
+
+    int size()
+    {
+        return root ? root->size : 0;
+    }
+};
+
+#endif
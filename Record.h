@@ -0,0 +1,18 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <string>
+using namespace std;
+
+// a single record as it is stored in the trees, used to hand whole datasets to the bulk operations
+struct Record
+{
+    int id;
+    string name;
+    int age;
+
+    Record(int id, string name, int age)
+        : id(id), name(move(name)), age(age) {}
+};
+
+#endif
@@ -0,0 +1,713 @@
+#ifndef STRING_BTREE_H
+#define STRING_BTREE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace std;
+
+// String B-Tree Node
+// Keys are stored prefix compressed: the prefix shared by every key in the node is kept once,
+// and only the remaining suffixes are stored, back to back in a node-local slab
+struct StringBTreeNode
+{
+    string prefix;                      // Common prefix of every key in the node
+    string slab;                        // Key suffixes stored back to back
+    vector<int> offsets;                // Suffix i is slab[offsets[i], offsets[i + 1])
+    vector<uint32_t> heads;             // First four bytes of each suffix, compared before the slab is touched
+    vector<StringBTreeNode *> children; // Array of child pointers
+    int t;                              // Minimum degree
+    int n;                              // Current number of keys
+    bool leaf;                          // Is true if node is a leaf
+
+    StringBTreeNode(int t, bool leaf)
+    {
+        this->t = t;
+        this->leaf = leaf;
+
+        children.assign(2 * t, nullptr);
+        offsets.assign(1, 0);
+        n = 0;
+    }
+
+    // First four bytes of a string packed big-endian, so comparing two heads orders them like the strings
+    static uint32_t head(const char *s, size_t length)
+    {
+        uint32_t h = 0;
+        for (size_t i = 0; i < 4; i++)
+        {
+            h = (h << 8) | (i < length ? (unsigned char)s[i] : 0); // short strings are padded with zeros
+        }
+        return h;
+    }
+
+    // Full key i, prefix and suffix put back together
+    string getKey(int i)
+    {
+        return prefix + slab.substr(offsets[i], offsets[i + 1] - offsets[i]);
+    }
+
+    // Length of key i, prefix included
+    size_t keyLength(int i)
+    {
+        return prefix.size() + offsets[i + 1] - offsets[i];
+    }
+
+    // Byte pos of key i, read from the prefix or the slab without putting the key together
+    char keyAt(int i, size_t pos)
+    {
+        return pos < prefix.size() ? prefix[pos] : slab[offsets[i] + pos - prefix.size()];
+    }
+
+    // Number of leading bytes key i of this node and key j of another node have in common
+    size_t sharedLength(int i, StringBTreeNode *other, int j)
+    {
+        size_t length = min(keyLength(i), other->keyLength(j));
+        size_t p = 0;
+        while (p < length && keyAt(i, p) == other->keyAt(j, p))
+        {
+            p++;
+        }
+        return p;
+    }
+
+    // Append the bytes of key j of another node from position start on to the slab, as a new suffix
+    void appendSuffix(StringBTreeNode *other, int j, size_t start)
+    {
+        size_t begin = slab.size();
+        size_t otherPrefix = other->prefix.size();
+        if (start < otherPrefix)
+        {
+            slab.append(other->prefix, start, string::npos);
+            start = otherPrefix;
+        }
+        slab.append(other->slab, other->offsets[j] + start - otherPrefix, other->offsets[j + 1] - other->offsets[j] - (start - otherPrefix));
+        offsets.push_back(slab.size());
+        heads.push_back(head(slab.data() + begin, slab.size() - begin));
+    }
+
+    void insertKey(int i, const string &key);
+    void removeSuffix(int i);
+    void eraseKey(int i);
+    void truncate(int count);
+    void appendKeys(StringBTreeNode *other, int first, int last);
+    void resetPrefix(size_t length);
+    void refreshPrefix();
+
+    // Compare suffix i with the part of the search key after the prefix
+    int compareSuffix(int i, const char *rest, size_t restLength, uint32_t restHead)
+    {
+        if (heads[i] != restHead)
+        {
+            return heads[i] < restHead ? -1 : 1; // decided by the fixed-width heads alone
+        }
+        size_t length = offsets[i + 1] - offsets[i];
+        int c = memcmp(slab.data() + offsets[i], rest, min(length, restLength));
+        if (c != 0)
+        {
+            return c;
+        }
+        return length < restLength ? -1 : (length > restLength ? 1 : 0);
+    }
+
+    // Index of the first key >= key, or > key when afterEqual is true
+    int findIndex(const string &key, bool afterEqual)
+    {
+        size_t p = prefix.size();
+        int c = key.compare(0, p, prefix);
+        if (c < 0)
+        {
+            return 0; // key sorts before every key in the node
+        }
+        if (c > 0)
+        {
+            return n; // key sorts after every key in the node
+        }
+
+        const char *rest = key.data() + p;
+        size_t restLength = key.size() - p;
+        uint32_t restHead = head(rest, restLength);
+
+        int lo = 0, hi = n;
+        while (lo < hi)
+        {
+            int mid = lo + (hi - lo) / 2;
+            int cmp = compareSuffix(mid, rest, restLength, restHead);
+            if (cmp < 0 || (afterEqual && cmp == 0))
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        return lo;
+    }
+
+    bool keyEquals(int i, const string &key)
+    {
+        size_t p = prefix.size();
+        if (key.size() < p || key.compare(0, p, prefix) != 0)
+        {
+            return false;
+        }
+        return compareSuffix(i, key.data() + p, key.size() - p, head(key.data() + p, key.size() - p)) == 0;
+    }
+
+    StringBTreeNode *search(const string &key)
+    {
+        int i = findIndex(key, false);
+
+        if (i < n && keyEquals(i, key))
+        {
+            return this;
+        }
+
+        if (leaf)
+        {
+            return nullptr;
+        }
+
+        return children[i]->search(key);
+    }
+
+    void insertNonFull(const string &key);
+    void splitChild(int i, StringBTreeNode *y);
+    bool remove(const string &key);
+    void removeFromLeaf(int idx);
+    void removeFromNonLeaf(int idx);
+    void replaceKey(int idx, const string &key);
+    string getPredecessor(int idx);
+    string getSuccessor(int idx);
+    void fill(int idx);
+    void borrowFromPrev(int idx);
+    void borrowFromNext(int idx);
+    void merge(int idx);
+};
+
+// String B-Tree Class
+class StringBTree
+{
+private:
+    StringBTreeNode *root;
+    int t;
+
+    void destroy(StringBTreeNode *node);
+    long long keyBytes(StringBTreeNode *node);
+
+public:
+    StringBTree(int t)
+    {
+        root = nullptr;
+        this->t = t;
+    }
+
+    // The tree owns its nodes, a copy would free them a second time
+    StringBTree(const StringBTree &) = delete;
+    StringBTree &operator=(const StringBTree &) = delete;
+
+    ~StringBTree()
+    {
+        destroy(root);
+    }
+
+    StringBTreeNode *search(const string &key)
+    {
+        return root ? root->search(key) : nullptr;
+    }
+
+    // Bytes used to store the keys, prefixes and suffixes together
+    long long keyBytes()
+    {
+        return keyBytes(root);
+    }
+
+    void insert(const string &key);
+    bool remove(const string &key);
+};
+
+// Free a node and every node below it
+void StringBTree::destroy(StringBTreeNode *node)
+{
+    if (!node)
+    {
+        return;
+    }
+    if (!node->leaf)
+    {
+        for (int i = 0; i <= node->n; i++)
+        {
+            destroy(node->children[i]);
+        }
+    }
+    delete node;
+}
+
+long long StringBTree::keyBytes(StringBTreeNode *node)
+{
+    if (!node)
+    {
+        return 0;
+    }
+    long long total = node->prefix.size() + node->slab.size();
+    if (!node->leaf)
+    {
+        for (int i = 0; i <= node->n; i++)
+        {
+            total += keyBytes(node->children[i]);
+        }
+    }
+    return total;
+}
+
+// Insert a key into the String B-Tree
+void StringBTree::insert(const string &key)
+{
+    if (!root)
+    {
+        root = new StringBTreeNode(t, true);
+        root->insertKey(0, key);
+    }
+    else
+    {
+        if (root->n == 2 * t - 1)
+        {
+            StringBTreeNode *s = new StringBTreeNode(t, false);
+            s->children[0] = root;
+            s->splitChild(0, root);
+
+            int i = 0;
+            if (s->getKey(0) < key)
+            {
+                i++;
+            }
+            s->children[i]->insertNonFull(key);
+
+            root = s;
+        }
+        else
+        {
+            root->insertNonFull(key);
+        }
+    }
+}
+
+// Insert a key at index i, splicing its suffix into the slab
+// Only a new first or last key can leave the shared prefix, then the prefix is cut back before the splice
+void StringBTreeNode::insertKey(int i, const string &key)
+{
+    if (n == 0)
+    {
+        prefix = key; // a single key is all prefix
+        slab.clear();
+        offsets.assign(2, 0);
+        heads.assign(1, head("", 0));
+        n = 1;
+        return;
+    }
+
+    size_t shared = 0;
+    while (shared < prefix.size() && shared < key.size() && key[shared] == prefix[shared])
+    {
+        shared++;
+    }
+    if (shared < prefix.size())
+    {
+        resetPrefix(shared);
+    }
+
+    int length = key.size() - shared;
+    slab.insert(offsets[i], key, shared, string::npos);
+    offsets.insert(offsets.begin() + i + 1, offsets[i] + length);
+    for (int j = i + 2; j <= n + 1; j++)
+    {
+        offsets[j] += length; // the suffixes after the new one moved right
+    }
+    heads.insert(heads.begin() + i, head(key.data() + shared, length));
+    n++;
+}
+
+// Cut the suffix of key i out of the slab, the prefix is left as it is
+void StringBTreeNode::removeSuffix(int i)
+{
+    int length = offsets[i + 1] - offsets[i];
+    slab.erase(offsets[i], length);
+    offsets.erase(offsets.begin() + i + 1);
+    for (int j = i + 1; j < n; j++)
+    {
+        offsets[j] -= length; // the suffixes after the removed one moved left
+    }
+    heads.erase(heads.begin() + i);
+    n--;
+}
+
+// Remove key i, the shared prefix can only grow when the first or last key goes
+void StringBTreeNode::eraseKey(int i)
+{
+    removeSuffix(i);
+    if (i == 0 || i == n)
+    {
+        refreshPrefix();
+    }
+}
+
+// Keep the first count keys
+void StringBTreeNode::truncate(int count)
+{
+    slab.resize(offsets[count]);
+    offsets.resize(count + 1);
+    heads.resize(count);
+    n = count;
+    refreshPrefix();
+}
+
+// Append keys [first, last) of another node, all of them sort after the keys of this node
+void StringBTreeNode::appendKeys(StringBTreeNode *other, int first, int last)
+{
+    if (first == last)
+    {
+        return;
+    }
+    if (n == 0)
+    {
+        // the prefix is what the first and last appended key share
+        size_t shared = other->sharedLength(first, other, last - 1);
+        size_t otherPrefix = other->prefix.size();
+        prefix.assign(other->prefix, 0, min(shared, otherPrefix));
+        if (shared > otherPrefix)
+        {
+            prefix.append(other->slab, other->offsets[first], shared - otherPrefix);
+        }
+        slab.clear();
+        offsets.assign(1, 0);
+        heads.clear();
+    }
+    else
+    {
+        size_t shared = sharedLength(0, other, last - 1); // the new first and last key
+        if (shared < prefix.size())
+        {
+            resetPrefix(shared);
+        }
+    }
+
+    for (int j = first; j < last; j++)
+    {
+        appendSuffix(other, j, prefix.size());
+        n++;
+    }
+}
+
+// Re-encode the keys so that their first length bytes form the prefix
+void StringBTreeNode::resetPrefix(size_t length)
+{
+    size_t p = prefix.size();
+    if (length == p)
+    {
+        return;
+    }
+
+    string moved = length < p ? prefix.substr(length) : ""; // bytes that move from the prefix into every suffix
+    size_t cut = length > p ? length - p : 0;               // bytes that move from every suffix into the prefix
+    if (cut > 0)
+    {
+        prefix.append(slab, offsets[0], cut);
+    }
+    else
+    {
+        prefix.resize(length);
+    }
+
+    string rebuilt;
+    rebuilt.reserve(slab.size() + n * moved.size());
+    int start = 0;
+    for (int i = 0; i < n; i++)
+    {
+        int begin = rebuilt.size();
+        rebuilt += moved;
+        rebuilt.append(slab, offsets[i] + cut, offsets[i + 1] - offsets[i] - cut);
+        offsets[i] = start;
+        start = rebuilt.size();
+        heads[i] = head(rebuilt.data() + begin, rebuilt.size() - begin);
+    }
+    offsets[n] = start;
+    slab.swap(rebuilt);
+}
+
+// Make the prefix the longest one the keys share again, after the first or last key changed
+// The keys are sorted, so the prefix shared by the first and last key is shared by all of them
+void StringBTreeNode::refreshPrefix()
+{
+    if (n == 0)
+    {
+        prefix.clear();
+        slab.clear();
+        offsets.assign(1, 0);
+        heads.clear();
+        return;
+    }
+    resetPrefix(sharedLength(0, this, n - 1));
+}
+
+// Insert a key into a non-full node
+void StringBTreeNode::insertNonFull(const string &key)
+{
+    int i = findIndex(key, true); // equal keys stay in insertion order, like in the integer B-Tree
+
+    if (leaf)
+    {
+        insertKey(i, key);
+    }
+    else
+    {
+        if (children[i]->n == 2 * t - 1)
+        {
+            splitChild(i, children[i]);
+
+            if (getKey(i) < key)
+            {
+                i++;
+            }
+        }
+        children[i]->insertNonFull(key);
+    }
+}
+
+// Split a full child
+void StringBTreeNode::splitChild(int i, StringBTreeNode *y)
+{
+    StringBTreeNode *z = new StringBTreeNode(y->t, y->leaf);
+    z->appendKeys(y, t, y->n);
+
+    if (!y->leaf)
+    {
+        for (int j = 0; j < t; j++)
+        {
+            z->children[j] = y->children[j + t];
+        }
+    }
+
+    string median = y->getKey(t - 1);
+    y->truncate(t - 1);
+
+    for (int j = n; j >= i + 1; j--)
+    {
+        children[j + 1] = children[j];
+    }
+
+    children[i + 1] = z;
+
+    insertKey(i, median);
+}
+
+// Remove a key from the String B-Tree, returns false if the key is not in the tree
+bool StringBTree::remove(const string &key)
+{
+    if (!root)
+    {
+        return false;
+    }
+
+    bool removed = root->remove(key);
+
+    if (root->n == 0)
+    {
+        StringBTreeNode *temp = root;
+        root = root->leaf ? nullptr : root->children[0];
+        delete temp;
+    }
+    return removed;
+}
+
+// Remove a key from a node
+bool StringBTreeNode::remove(const string &key)
+{
+    int idx = findIndex(key, false);
+
+    if (idx < n && keyEquals(idx, key))
+    {
+        if (leaf)
+        {
+            removeFromLeaf(idx);
+        }
+        else
+        {
+            removeFromNonLeaf(idx);
+        }
+        return true;
+    }
+
+    if (leaf)
+    {
+        return false;
+    }
+
+    bool flag = (idx == n);
+    if (children[idx]->n < t)
+    {
+        fill(idx);
+    }
+
+    if (flag && idx > n)
+    {
+        idx--;
+    }
+    return children[idx]->remove(key);
+}
+
+// Remove from a leaf node
+void StringBTreeNode::removeFromLeaf(int idx)
+{
+    eraseKey(idx);
+}
+
+// Remove from a non-leaf node
+void StringBTreeNode::removeFromNonLeaf(int idx)
+{
+    string k = getKey(idx);
+
+    if (children[idx]->n >= t)
+    {
+        string pred = getPredecessor(idx);
+        replaceKey(idx, pred);
+        children[idx]->remove(pred);
+    }
+    else if (children[idx + 1]->n >= t)
+    {
+        string succ = getSuccessor(idx);
+        replaceKey(idx, succ);
+        children[idx + 1]->remove(succ);
+    }
+    else
+    {
+        merge(idx);
+        children[idx]->remove(k);
+    }
+}
+
+// Overwrite a single key, the prefix is only recomputed when the first or last key is replaced
+void StringBTreeNode::replaceKey(int idx, const string &key)
+{
+    removeSuffix(idx);
+    insertKey(idx, key);
+    if (idx == 0 || idx == n - 1)
+    {
+        refreshPrefix();
+    }
+}
+
+// Get predecessor of a key
+string StringBTreeNode::getPredecessor(int idx)
+{
+    StringBTreeNode *cur = children[idx];
+    while (!cur->leaf)
+    {
+        cur = cur->children[cur->n];
+    }
+    return cur->getKey(cur->n - 1);
+}
+
+// Get successor of a key
+string StringBTreeNode::getSuccessor(int idx)
+{
+    StringBTreeNode *cur = children[idx + 1];
+    while (!cur->leaf)
+    {
+        cur = cur->children[0];
+    }
+    return cur->getKey(0);
+}
+
+// Fill a child node
+void StringBTreeNode::fill(int idx)
+{
+    if (idx != 0 && children[idx - 1]->n >= t)
+    {
+        borrowFromPrev(idx);
+    }
+    else if (idx != n && children[idx + 1]->n >= t)
+    {
+        borrowFromNext(idx);
+    }
+    else
+    {
+        if (idx != n)
+        {
+            merge(idx);
+        }
+        else
+        {
+            merge(idx - 1);
+        }
+    }
+}
+
+// Borrow from the previous child
+void StringBTreeNode::borrowFromPrev(int idx)
+{
+    StringBTreeNode *child = children[idx];
+    StringBTreeNode *sibling = children[idx - 1];
+
+    if (!child->leaf)
+    {
+        for (int i = child->n; i >= 0; i--)
+        {
+            child->children[i + 1] = child->children[i];
+        }
+        child->children[0] = sibling->children[sibling->n];
+    }
+
+    child->insertKey(0, getKey(idx - 1));
+    replaceKey(idx - 1, sibling->getKey(sibling->n - 1));
+    sibling->eraseKey(sibling->n - 1);
+}
+
+// Borrow from the next child
+void StringBTreeNode::borrowFromNext(int idx)
+{
+    StringBTreeNode *child = children[idx];
+    StringBTreeNode *sibling = children[idx + 1];
+
+    if (!child->leaf)
+    {
+        child->children[child->n + 1] = sibling->children[0];
+        for (int i = 1; i <= sibling->n; i++)
+        {
+            sibling->children[i - 1] = sibling->children[i];
+        }
+    }
+
+    child->insertKey(child->n, getKey(idx));
+    replaceKey(idx, sibling->getKey(0));
+    sibling->eraseKey(0);
+}
+
+// Merge two child nodes
+void StringBTreeNode::merge(int idx)
+{
+    StringBTreeNode *child = children[idx];
+    StringBTreeNode *sibling = children[idx + 1];
+
+    if (!child->leaf)
+    {
+        for (int i = 0; i <= sibling->n; i++)
+        {
+            child->children[child->n + 1 + i] = sibling->children[i];
+        }
+    }
+
+    child->insertKey(child->n, getKey(idx));
+    child->appendKeys(sibling, 0, sibling->n);
+
+    for (int i = idx + 2; i <= n; i++)
+    {
+        children[i - 1] = children[i];
+    }
+    eraseKey(idx);
+
+    delete sibling;
+}
+
+#endif
@@ -1,15 +1,49 @@
 #include <iostream>
+#include <atomic>
 #include <chrono>  // for measuring time
 #include <cstdlib> // for rand()
 #include <ctime>   // for time()
+#include <mutex>
+#include <shared_mutex> // lock for the mutable AVL shared by readers and a writer
+#include <thread>
+#include <vector>
 #include "BST.h"
 #include "AVL.h"
 #include "BTree.h"
+#include "ART.h"
+#include "CompactAVL.h"
+#include "StringBTree.h"
+#include "ComplexityFitter.h"
+#include "CycleTimer.h"
+#include "Dataset.h"
+#include "BEpsilonTree.h"
+#include "MultiIndex.h"
+#include "PersistentAVL.h"
+#include "AsyncLookup.h"
 
 using namespace std;
+
+const int SWEEP_START = 1000;       // smallest dataset size of the complexity sweep
+const int SWEEP_SEARCHES = 20000;   // random searches timed in every trial of the sweep
+const int SWEEP_TRIALS = 3;         // fewest trials per size, the median one is kept to filter out noise
+const int SWEEP_INSERTS = 200000;   // inserts timed per size at the least, small sizes run more trials to reach it
+const int SAMPLED_SEARCHES = 10000; // searches run for the per-operation timing
+const int SAMPLE_RATE = 10;         // one search in SAMPLE_RATE is timed on its own
+const int BST_SWEEP_LIMIT = 16000;  // sorted input turns the BST into a list, past this it is too slow and recurses too deep
+const int BUFFERED_NODE_SIZE = 128; // slots per node of the B^e-Tree, split between children and buffered messages
+const int EXPIRY_BATCHES = 5;       // the oldest half of the ids expires in this many contiguous batches
+const int AGE_QUERIES = 20;         // queries by age timed against full scans
+const int AGE_RANGE_WIDTH = 5;      // ages covered by one age range query
+const int RANGE_SCAN_WIDTH = 1000;  // ids covered by one ordered range scan of the adaptive radix tree
+const int SNAPSHOT_LOOKUPS = 1000;  // lookups a reader runs on one pinned version before it takes a newer one
+const int MAX_IN_FLIGHT = 64;       // most coroutine lookups kept in progress at once by the interleaving sweep
+
 class PerformanceTester
 {
 private:
+    CycleTimer timer; // calibrated once at startup
+    int sampleRate;   // one operation in sampleRate is timed on its own
+
     // Method to calculate and display timing results
     void displayResults(const string &operation, double totalTime, int datasetSize, int iterations = 0)
     {
@@ -35,15 +69,350 @@ private:
         }
     }
 
+    // Method to time single searches with the cycle timer and display their distribution
+    template <typename Tree>
+    void displaySampledSearch(Tree &tree, int datasetSize)
+    {
+        OperationSampler sampler(timer, sampleRate);
+        int found = 0;
+        for (int i = 0; i < SAMPLED_SEARCHES; i++)
+        {
+            int key = rand() % datasetSize; // the key is picked outside the timed region
+            sampler.run([&]()
+                        { found += tree.search(key) ? 1 : 0; });
+        }
+
+        cout << "- Sampled Search Results (" << sampler.count() << " of " << SAMPLED_SEARCHES << " searches timed, "
+             << found << " found):\n";
+        cout << "Mean: " << sampler.mean() << " ns, Median: " << sampler.percentile(0.5)
+             << " ns, 99th Percentile: " << sampler.percentile(0.99) << " ns per operation" << endl;
+        cout << endl;
+    }
+
+    // Methods to insert one record of the dataset into each kind of tree
+    void insertRecord(BinarySearchTree &tree, const Dataset &data, int id)
+    {
+        tree.insert(data.ids[id], data.name(id), data.ages[id]);
+    }
+
+    void insertRecord(AVL &tree, const Dataset &data, int id)
+    {
+        tree.insert(data.ids[id], data.name(id), data.ages[id]);
+    }
+
+    void insertRecord(BTree &tree, const Dataset &data, int id)
+    {
+        tree.insert(data.ids[id]);
+    }
+
+    void insertRecord(ART &tree, const Dataset &data, int id)
+    {
+        tree.insert(data.ids[id], data.name(id), data.ages[id]);
+    }
+
+    // Method to time insert, search and delete on one tree, the same way testTrees does
+    // perOperation receives the average time of each operation in nanoseconds
+    template <typename Tree>
+    void timeOperations(Tree &tree, const Dataset &data, int datasetSize, double *perOperation)
+    {
+        vector<int> searchKeys(SWEEP_SEARCHES);
+        generateRandomKeys(searchKeys.data(), SWEEP_SEARCHES, datasetSize);
+
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < datasetSize; i++)
+        {
+            insertRecord(tree, data, i); // sorted ids, like testTrees
+        }
+        auto end = chrono::high_resolution_clock::now();
+        perOperation[0] = chrono::duration<double, nano>(end - start).count() / datasetSize;
+
+        int found = 0;
+        start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < SWEEP_SEARCHES; i++)
+        {
+            found += tree.search(searchKeys[i]) ? 1 : 0;
+        }
+        end = chrono::high_resolution_clock::now();
+        perOperation[1] = chrono::duration<double, nano>(end - start).count() / SWEEP_SEARCHES;
+
+        start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < datasetSize; i++)
+        {
+            tree.remove(i);
+        }
+        end = chrono::high_resolution_clock::now();
+        perOperation[2] = chrono::duration<double, nano>(end - start).count() / datasetSize;
+
+        if (found != SWEEP_SEARCHES)
+        {
+            cout << "Warning: only " << found << " of " << SWEEP_SEARCHES << " searched keys were found" << endl;
+        }
+    }
+
+    // Method to fit the measurements of one operation and display the best-fit class
+    void displayFit(const string &operation, const vector<double> &sizes, const vector<double> &times, ComplexityClass expected)
+    {
+        ComplexityFit fit = fitComplexity(sizes, times);
+        cout << "- " << operation << ": " << complexityName(fit.complexity)
+             << ", time = " << fit.a << " ns + " << fit.b << " ns * " << complexityTerm(fit.complexity)
+             << ", R^2 = " << fit.rSquared << ", relative error = " << fit.relativeError
+             << ", log-log slope = " << fit.slope << endl;
+        if (growsFasterThan(fit, expected, sizes))
+        {
+            cout << "  WARNING: expected " << complexityName(expected) << ", grows faster than expected" << endl;
+        }
+        else if (fit.complexity > expected)
+        {
+            cout << "  note: the slope is within what " << complexityName(expected) << " and cache misses allow" << endl;
+        }
+    }
+
+    // Method to run one kind of tree across the sweep sizes and fit every operation
+    template <typename Tree, typename MakeTree>
+    void sweepTree(const string &name, const Dataset &data, const vector<int> &sizes, int limit, MakeTree makeTree)
+    {
+        cout << "------------------- Sweeping " << name << " -------------------" << endl
+             << endl;
+
+        vector<double> fitSizes;
+        vector<double> times[3];
+        for (int size : sizes)
+        {
+            if (size > limit)
+            {
+                cout << "n = " << size << ": skipped" << endl;
+                continue;
+            }
+            // a size of 1000 takes microseconds, a single interval that short is mostly timer and scheduler noise
+            int trials = max(SWEEP_TRIALS, SWEEP_INSERTS / size);
+            vector<double> trialTimes[3];
+            for (int trial = 0; trial < trials; trial++)
+            {
+                Tree tree = makeTree();
+                double perTrial[3];
+                timeOperations(tree, data, size, perTrial);
+                for (int op = 0; op < 3; op++)
+                {
+                    trialTimes[op].push_back(perTrial[op]);
+                }
+            }
+            double perOperation[3];
+            for (int op = 0; op < 3; op++)
+            {
+                nth_element(trialTimes[op].begin(), trialTimes[op].begin() + trials / 2, trialTimes[op].end());
+                perOperation[op] = trialTimes[op][trials / 2]; // the median trial
+            }
+
+            cout << "n = " << size << ": insert " << perOperation[0] << " ns, search " << perOperation[1]
+                 << " ns, delete " << perOperation[2] << " ns per operation" << endl;
+
+            fitSizes.push_back(size);
+            for (int op = 0; op < 3; op++)
+            {
+                times[op].push_back(max(perOperation[op], 1e-3)); // the fit divides by the times, keep them positive
+            }
+        }
+        cout << endl;
+
+        if (fitSizes.size() < 3)
+        {
+            cout << "Not enough sizes to fit a model" << endl
+                 << endl;
+            return;
+        }
+
+        // every operation of an ordered search tree is expected to stay logarithmic per operation
+        displayFit("Insert", fitSizes, times[0], LOGARITHMIC);
+        displayFit("Search", fitSizes, times[1], LOGARITHMIC);
+        displayFit("Delete", fitSizes, times[2], LOGARITHMIC);
+        cout << endl;
+    }
+
+    // Method to draw a random key on a reader thread, rand() is not safe to share between threads
+    int nextKey(unsigned &seed, int maxKey)
+    {
+        seed = seed * 1103515245u + 12345u; // every reader keeps its own linear congruential generator
+        return (seed >> 8) % maxKey;
+    }
+
+    // Method to time reader threads searching while one writer thread keeps updating the same tree
+    // read(reader, lookups) returns the keys found, write(step) makes one update; the writer stops when the readers are done
+    template <typename Read, typename Write>
+    void raceReaders(const string &name, int readers, int lookups, Read read, Write write)
+    {
+        atomic<bool> done(false);
+        long long updates = 0;
+        vector<long long> found(readers);
+        thread writer([&]()
+                      {
+            while (!done.load())
+            {
+                write(updates++);
+            } });
+
+        vector<thread> workers;
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int r = 0; r < readers; r++)
+        {
+            workers.emplace_back([&, r]()
+                                 { found[r] = read(r, lookups); });
+        }
+        for (thread &worker : workers)
+        {
+            worker.join();
+        }
+        auto end = chrono::high_resolution_clock::now(); // storing ending time
+        done = true;
+        writer.join();
+
+        long long total = 0;
+        for (long long count : found)
+        {
+            total += count;
+        }
+        double readTime = chrono::duration<double, milli>(end - start).count();                         // calculate the total time taken
+        displayResults(name + " with " + to_string(readers) + " readers", readTime, readers * lookups); // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Lookups per ms: " << (long long)readers * lookups / readTime << endl;
+        cout << "Keys found: " << total << ", writer updates meanwhile: " << updates << endl
+             << endl;
+    }
+
+    // Method to time random lookups on one tree with a plain search loop, then as coroutines interleaved on this thread
+    // with 1, 2, 4, ... up to MAX_IN_FLIGHT lookups in progress at a time
+    template <typename T, typename Tree>
+    void interleaveTree(const string &name, Tree &tree, const vector<int> &keys)
+    {
+        int lookups = keys.size();
+        cout << "------------------- Interleaved " << name << " Lookups -------------------" << endl
+             << endl;
+
+        // Measuring Search Time
+        long long found = 0;
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int key : keys)
+        {
+            found += tree.search(key) ? 1 : 0; // every step waits for the node it needs
+        }
+        auto end = chrono::high_resolution_clock::now();                          // storing ending time
+        double searchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Synchronous Search", searchTime, lookups);                // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Keys found: " << found << endl
+             << endl;
+
+        for (int inFlight = 1; inFlight <= MAX_IN_FLIGHT; inFlight *= 2)
+        {
+            found = 0;
+            start = chrono::high_resolution_clock::now(); // storing start time
+            interleaveLookups<T>(
+                lookups, inFlight, [&tree, &keys](int i)
+                { return find(tree, keys[i]); },
+                [&found](int, T result)
+                { found += result ? 1 : 0; });                                                                  // the other lookups run while each one waits for its next node
+            end = chrono::high_resolution_clock::now();                                                         // storing ending time
+            searchTime = chrono::duration<double, milli>(end - start).count();                                  // calculate the total time taken
+            displayResults("Coroutine Search with " + to_string(inFlight) + " in flight", searchTime, lookups); // displaying the results i.e. total time taken and average time taken per operation
+            cout << "Keys found: " << found << endl
+                 << endl;
+        }
+    }
+
+    // Method to expire the oldest half of the ids from one kind of tree, one remove at a time and with range erases,
+    // then to erase every other remaining id, one remove at a time and as one batch
+    template <typename Tree, typename MakeTree>
+    void expireTree(const string &name, const Dataset &data, const vector<int> &ids, MakeTree makeTree)
+    {
+        int datasetSize = ids.size();
+        Tree looped = makeTree();
+        Tree ranged = makeTree();
+        for (int id : ids)
+        {
+            insertRecord(looped, data, id); // the trees are loaded in random order, outside the timed region
+            insertRecord(ranged, data, id);
+        }
+
+        cout << "------------------- Expiring " << name << " -------------------" << endl
+             << endl;
+
+        int expired = datasetSize / 2;
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id = 0; id < expired; id++)
+        {
+            looped.remove(id); // every remove walks down from the root
+        }
+        auto end = chrono::high_resolution_clock::now();                        // storing ending time
+        double loopTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Expire with remove", loopTime, expired);                // displaying the results i.e. total time taken and average time taken per operation
+
+        int erased = 0;
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int batch = 0; batch < EXPIRY_BATCHES; batch++)
+        {
+            int lo = (long long)expired * batch / EXPIRY_BATCHES;
+            int hi = (long long)expired * (batch + 1) / EXPIRY_BATCHES - 1;
+            erased += ranged.eraseRange(lo, hi); // the whole batch is cut out at once
+        }
+        end = chrono::high_resolution_clock::now();                              // storing ending time
+        double rangeTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Expire with eraseRange", rangeTime, expired);            // displaying the results i.e. total time taken and average time taken per operation
+
+        // every other id that is left, no two of them are consecutive
+        vector<int> scattered;
+        for (int id = expired; id < datasetSize; id += 2)
+        {
+            scattered.push_back(id);
+        }
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : scattered)
+        {
+            looped.remove(id); // removing the data
+        }
+        end = chrono::high_resolution_clock::now();                      // storing ending time
+        loopTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Scattered remove", loopTime, scattered.size());  // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now();                       // storing start time
+        erased += ranged.eraseMany(scattered);                              // removing the whole batch at once
+        end = chrono::high_resolution_clock::now();                         // storing ending time
+        rangeTime = chrono::duration<double, milli>(end - start).count();   // calculate the total time taken
+        displayResults("Scattered eraseMany", rangeTime, scattered.size()); // displaying the results i.e. total time taken and average time taken per operation
+
+        cout << "Records erased: " << erased << " of " << expired + scattered.size() << endl
+             << endl;
+    }
+
+    // Method to generate the ids 0 to numKeys - 1 in random order
+    vector<int> generateShuffledIds(int numKeys)
+    {
+        vector<int> ids(numKeys);
+        for (int i = 0; i < numKeys; i++)
+        {
+            ids[i] = i;
+        }
+        for (int i = numKeys - 1; i > 0; i--)
+        {
+            swap(ids[i], ids[rand() % (i + 1)]); // Fisher-Yates shuffle
+        }
+        return ids;
+    }
+
 public:
+    PerformanceTester(int sampleRate = SAMPLE_RATE) : sampleRate(sampleRate) {}
+
     void testTrees(int datasetSize)
     {
         srand(time(0)); // Seed random number generator
 
+        cout << "Timer: " << (timer.usesTsc() ? "invariant TSC" : "steady clock") << " at " << timer.frequencyGHz()
+             << " GHz, " << timer.overheadNs() << " ns overhead subtracted from every timed operation" << endl
+             << endl;
+
         // Dummy Keys for testing
         int randomKeys[20];
         generateRandomKeys(randomKeys, 20, datasetSize);
 
+        Dataset data(datasetSize); // every record is formatted here, before any timing starts
+
         // ------------------------ BST ------------------------
         BinarySearchTree BST;
         cout << "------------------- Testing BSTs -------------------" << endl
@@ -53,7 +422,7 @@ public:
         auto start = chrono::high_resolution_clock::now(); // storing start time
         for (int i = 0; i < datasetSize; i++)
         {
-            BST.insert(i, "Name: alpha_" + to_string(i + 1), i % 100); // inserting the data
+            BST.insert(data.ids[i], data.name(i), data.ages[i]); // inserting the data
         }
         auto end = chrono::high_resolution_clock::now();                             // storing ending time
         double BSTInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
@@ -68,6 +437,7 @@ public:
         end = chrono::high_resolution_clock::now();                                  // storing ending time
         double BSTSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
         displayResults("Search", BSTSearchTime, 20, 20);                             // displaying the results i.e. total time taken and average time taken per operation
+        displaySampledSearch(BST, datasetSize);                                      // timing single searches
 
         // Measuring Deletion Time
         start = chrono::high_resolution_clock::now(); // storing start time
@@ -91,7 +461,7 @@ public:
         start = chrono::high_resolution_clock::now(); // storing start time
         for (int i = 0; i < datasetSize; i++)
         {
-            avl.insert(i, "Name: Comrade_" + to_string(i + 1), i % 100); // inserting the data
+            avl.insert(data.ids[i], data.name(i), data.ages[i]); // inserting the data
         }
         end = chrono::high_resolution_clock::now();                                  // storing ending time
         double avlInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
@@ -106,6 +476,7 @@ public:
         end = chrono::high_resolution_clock::now();                                  // storing ending time
         double avlSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
         displayResults("Search", avlSearchTime, 20, 20);                             // displaying the results i.e. total time taken and average time taken per operation
+        displaySampledSearch(avl, datasetSize);                                      // timing single searches
 
         // Measuring Deletion Time
         start = chrono::high_resolution_clock::now(); // storing start time
@@ -128,7 +499,7 @@ public:
         start = chrono::high_resolution_clock::now(); // storing start time
         for (int i = 0; i < datasetSize; i++)
         {
-            btree.insert(i); // inserting the data
+            btree.insert(data.ids[i]); // inserting the data
         }
         end = chrono::high_resolution_clock::now();                                    // storing ending time
         double btreeInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
@@ -143,6 +514,7 @@ public:
         end = chrono::high_resolution_clock::now();                                    // storing ending time
         double btreeSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
         displayResults("Search", btreeSearchTime, 20, 20);                             // displaying the results i.e. total time taken and average time taken per operation
+        displaySampledSearch(btree, datasetSize);                                      // timing single searches
 
         // Measuring Deletion Time
         start = chrono::high_resolution_clock::now(); // storing start time
@@ -155,19 +527,1012 @@ public:
         displayResults("Delete", btreeDeleteTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
         // cout << "-----------------------------------------------" << endl
         //      << endl;
+
+        // ------------------------ ART ------------------------
+        ART art;
+        cout << "------------------- Testing Adaptive Radix Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            art.insert(data.ids[i], data.name(i), data.ages[i]); // inserting the data
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double artInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert", artInsertTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            art.search(randomKeys[i]); // searching the random keys
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double artSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Search", artSearchTime, 20, 20);                             // displaying the results i.e. total time taken and average time taken per operation
+        displaySampledSearch(art, datasetSize);                                      // timing single searches
+
+        // Measuring Range Scan Time
+        long long scanned = 0;
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            art.forRange(randomKeys[i], randomKeys[i] + RANGE_SCAN_WIDTH - 1, [&scanned](ARTLeaf *)
+                         { scanned++; }); // visiting the ids of the range in order
+        }
+        end = chrono::high_resolution_clock::now();                                // storing ending time
+        double artScanTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Range Scan", artScanTime, 20, 20);                         // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Keys found: " << scanned << endl
+             << endl;
+
+        // Measuring Deletion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            art.remove(i); // removing the data
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double artDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Delete", artDeleteTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
     }
-};
 
-int main()
-{
-    PerformanceTester tester;
+    void testBulkBuild(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
 
-    int datasetSize;
-    cout << "Enter the number of records to test: ";
-    cin >> datasetSize;
-    cout << endl;
+        // unsorted input, the case where a serial insert loop cannot take any shortcut
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+        vector<Record> records = data.records(ids);
+
+        // ------------------------ AVL ------------------------
+        cout << "------------------- Bulk Building AVL-Trees -------------------" << endl
+             << endl;
+
+        AVL serialAvl;
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            serialAvl.insert(records[i].id, records[i].name, records[i].age); // inserting the data one record at a time
+        }
+        auto end = chrono::high_resolution_clock::now();                             // storing ending time
+        double avlInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Serial Insert", avlInsertTime, datasetSize);                 // displaying the results i.e. total time taken and average time taken per operation
+
+        AVL bulkAvl;
+        start = chrono::high_resolution_clock::now();                               // storing start time
+        bulkAvl.build(move(records));                                               // sorting and building on all cores, the records are moved in and not copied
+        end = chrono::high_resolution_clock::now();                                 // storing ending time
+        double avlBuildTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Parallel Build", avlBuildTime, datasetSize);                // displaying the results i.e. total time taken and average time taken per operation
+
+        // ------------------------ B-Tree ------------------------
+        cout << "------------------- Bulk Building B-Trees -------------------" << endl
+             << endl;
+
+        BTree serialBtree(3);
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            serialBtree.insert(ids[i]); // inserting the data one key at a time
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double btreeInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Serial Insert", btreeInsertTime, datasetSize);                 // displaying the results i.e. total time taken and average time taken per operation
+
+        BTree bulkBtree(3);
+        start = chrono::high_resolution_clock::now();                                 // storing start time
+        bulkBtree.build(ids);                                                         // sorting and building on all cores
+        end = chrono::high_resolution_clock::now();                                   // storing ending time
+        double btreeBuildTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Parallel Build", btreeBuildTime, datasetSize);                // displaying the results i.e. total time taken and average time taken per operation
+
+        cout << "Threads used: " << threadBudget() << endl
+             << endl;
+    }
+
+    void testBatchUpdates(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        // the live index holds the even ids, the delta batch brings in the odd ones
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+        vector<int> baseIds, deltaIds, expired;
+        for (int i = 0; i < datasetSize; i++)
+        {
+            if (ids[i] % 2 == 0)
+            {
+                baseIds.push_back(ids[i]);
+            }
+            else
+            {
+                deltaIds.push_back(ids[i]);
+            }
+            if (ids[i] % 4 == 0)
+            {
+                expired.push_back(ids[i]); // half of the base records get erased again
+            }
+        }
+        vector<Record> base = data.records(baseIds);
+        vector<Record> delta = data.records(deltaIds);
+
+        cout << "------------------- Batch Updates on AVL-Trees -------------------" << endl
+             << endl;
+
+        AVL serialAvl, batchAvl;
+        serialAvl.build(vector<Record>(base)); // the copy is made here, outside the timed regions
+        batchAvl.build(move(base));
+
+        // Measuring Insertion Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (const Record &record : delta)
+        {
+            serialAvl.insert(record.id, record.name, record.age); // inserting the data one record at a time
+        }
+        auto end = chrono::high_resolution_clock::now();                                // storing ending time
+        double serialInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert Loop", serialInsertTime, delta.size());                  // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now();                                  // storing start time
+        batchAvl.insertMany(move(delta));                                              // merging the whole batch at once
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double batchInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert Many", batchInsertTime, deltaIds.size());               // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Deletion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : expired)
+        {
+            serialAvl.remove(id); // removing the data one record at a time
+        }
+        end = chrono::high_resolution_clock::now();                                     // storing ending time
+        double serialDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Remove Loop", serialDeleteTime, expired.size());                // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now();                                  // storing start time
+        batchAvl.eraseMany(expired);                                                   // removing the whole batch at once
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double batchDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Erase Many", batchDeleteTime, expired.size());                 // displaying the results i.e. total time taken and average time taken per operation
+
+        cout << "Threads used: " << threadBudget() << endl
+             << endl;
+    }
+
+    void testOrderStatistics(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        // Dummy Keys for testing
+        int randomKeys[20];
+        generateRandomKeys(randomKeys, 20, datasetSize);
+
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+        vector<Record> records = data.records(ids);
+
+        AVL avl;
+        avl.build(move(records));
+        BTree btree(3);
+        btree.build(ids);
+
+        // ------------------------ AVL ------------------------
+        cout << "------------------- Order Statistics on AVL-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Rank Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            avl.rank(randomKeys[i]); // position of the random key
+        }
+        auto end = chrono::high_resolution_clock::now();                           // storing ending time
+        double avlRankTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Rank", avlRankTime, 20, 20);                               // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Select Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            avl.select(randomKeys[i]); // record at the random position, e.g. a page boundary or a percentile
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double avlSelectTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Select", avlSelectTime, 20, 20);                             // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Range Count Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            avl.countRange(randomKeys[i], randomKeys[i] + datasetSize / 10); // counting a tenth of the id space
+        }
+        end = chrono::high_resolution_clock::now();                                 // storing ending time
+        double avlCountTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Range Count", avlCountTime, 20, 20);                        // displaying the results i.e. total time taken and average time taken per operation
 
-    tester.testTrees(datasetSize);
+        // ------------------------ B-Tree ------------------------
+        cout << "------------------- Order Statistics on B-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Rank Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            btree.rank(randomKeys[i]); // position of the random key
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double btreeRankTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Rank", btreeRankTime, 20, 20);                               // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Select Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            int key;
+            btree.select(randomKeys[i], key); // key at the random position, e.g. a page boundary or a percentile
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double btreeSelectTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Select", btreeSelectTime, 20, 20);                             // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Range Count Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < 20; i++)
+        {
+            btree.countRange(randomKeys[i], randomKeys[i] + datasetSize / 10); // counting a tenth of the id space
+        }
+        end = chrono::high_resolution_clock::now();                                   // storing ending time
+        double btreeCountTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Range Count", btreeCountTime, 20, 20);                        // displaying the results i.e. total time taken and average time taken per operation
+    }
+
+    void testCompactAVL(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        // random order for inserts and lookups, so every search walks cold paths
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+        vector<int> lookups = generateShuffledIds(datasetSize);
+
+        cout << "Node size: AVL " << sizeof(AVLNode) << " bytes, Compact AVL " << sizeof(CompactAVLNode)
+             << " bytes (+ " << sizeof(string) + sizeof(int) << " bytes of cold payload)" << endl
+             << endl;
+
+        // ------------------------ AVL ------------------------
+        AVL avl;
+        cout << "------------------- Testing AVL-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            avl.insert(ids[i], data.name(ids[i]), data.ages[ids[i]]); // inserting the data
+        }
+        auto end = chrono::high_resolution_clock::now();                             // storing ending time
+        double avlInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert", avlInsertTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time
+        int avlFound = 0;                             // counting the hits keeps the compiler from dropping the searches
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            avlFound += avl.search(lookups[i]); // searching every key once in random order
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double avlSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Search", avlSearchTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Keys found: " << avlFound << endl
+             << endl;
+
+        // Measuring Deletion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            avl.remove(lookups[i]); // removing the data
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double avlDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Delete", avlDeleteTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+
+        // ------------------------ Compact AVL ------------------------
+        CompactAVL compact;
+        cout << "------------------- Testing Compact AVL-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            compact.insert(ids[i], data.name(ids[i]), data.ages[ids[i]]); // inserting the data
+        }
+        end = chrono::high_resolution_clock::now();                                      // storing ending time
+        double compactInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert", compactInsertTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time
+        int compactFound = 0;                         // counting the hits keeps the compiler from dropping the searches
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            compactFound += compact.search(lookups[i]); // searching every key once in random order
+        }
+        end = chrono::high_resolution_clock::now();                                      // storing ending time
+        double compactSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Search", compactSearchTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Keys found: " << compactFound << endl
+             << endl;
+
+        // Measuring Deletion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            compact.remove(lookups[i]); // removing the data
+        }
+        end = chrono::high_resolution_clock::now();                                      // storing ending time
+        double compactDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Delete", compactDeleteTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+    }
+
+    void testStringBTree(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        // the names share the long "Name: alpha_" prefix, the case prefix compression is for
+        // the names are the keys here, so each one is copied out of the name column as a whole string before timing
+        Dataset data(datasetSize);
+        vector<string> names;
+        names.reserve(datasetSize);
+        long long rawBytes = 0;
+        for (int i = 0; i < datasetSize; i++)
+        {
+            names.emplace_back(data.name(i));
+            rawBytes += names[i].size();
+        }
+        vector<int> ids = generateShuffledIds(datasetSize);
+        vector<int> lookups = generateShuffledIds(datasetSize);
+
+        StringBTree btree(3);
+        cout << "------------------- Testing String B-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            btree.insert(names[ids[i]]); // inserting the names in random order
+        }
+        auto end = chrono::high_resolution_clock::now();                               // storing ending time
+        double btreeInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert", btreeInsertTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+
+        cout << "Key bytes stored: " << btree.keyBytes() << " (" << rawBytes << " without prefix compression)" << endl
+             << endl;
+
+        // Measuring Search Time
+        int found = 0;                                // counting the hits keeps the compiler from dropping the searches
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            found += btree.search(names[lookups[i]]) != nullptr; // searching every name once in random order
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double btreeSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Search", btreeSearchTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Keys found: " << found << endl
+             << endl;
+
+        // Measuring Deletion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            btree.remove(names[lookups[i]]); // removing the data
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double btreeDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Delete", btreeDeleteTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+    }
+
+    void testHints(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        Dataset data(datasetSize);
+
+        // lookups that wander around the id space in small steps, like a scan over recent records
+        vector<int> nearby(datasetSize);
+        int position = rand() % datasetSize;
+        for (int i = 0; i < datasetSize; i++)
+        {
+            position = min(datasetSize - 1, max(0, position + rand() % 33 - 16));
+            nearby[i] = position;
+        }
+
+        // ------------------------ AVL ------------------------
+        AVL avl, hintedAvl;
+        cout << "------------------- Hinted AVL-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            avl.insert(data.ids[i], data.name(i), data.ages[i]); // appending increasing ids from the root
+        }
+        auto end = chrono::high_resolution_clock::now();                             // storing ending time
+        double avlInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Sequential Insert", avlInsertTime, datasetSize);             // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            hintedAvl.hintedInsert(data.ids[i], data.name(i), data.ages[i]); // appending increasing ids from the finger
+        }
+        end = chrono::high_resolution_clock::now();                                        // storing ending time
+        double avlHintedInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Sequential Hinted Insert", avlHintedInsertTime, datasetSize);      // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time
+        int found = 0;                                // counting the hits keeps the compiler from dropping the searches
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            found += avl.search(nearby[i]); // searching from the root
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double avlSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Nearby Search", avlSearchTime, datasetSize);                 // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            found += hintedAvl.hintedFind(nearby[i]); // searching from the finger
+        }
+        end = chrono::high_resolution_clock::now();                                        // storing ending time
+        double avlHintedSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Nearby Hinted Find", avlHintedSearchTime, datasetSize);            // displaying the results i.e. total time taken and average time taken per operation
+
+        // ------------------------ B-Tree ------------------------
+        BTree btree(3), hintedBtree(3);
+        cout << "------------------- Hinted B-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            btree.insert(data.ids[i]); // appending increasing ids from the root
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double btreeInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Sequential Insert", btreeInsertTime, datasetSize);             // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            hintedBtree.hintedInsert(data.ids[i]); // appending increasing ids to the rightmost leaf
+        }
+        end = chrono::high_resolution_clock::now();                                          // storing ending time
+        double btreeHintedInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Sequential Hinted Insert", btreeHintedInsertTime, datasetSize);      // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            found += btree.search(nearby[i]) != nullptr; // searching from the root
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double btreeSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Nearby Search", btreeSearchTime, datasetSize);                 // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            found += hintedBtree.hintedFind(nearby[i]); // searching from the finger
+        }
+        end = chrono::high_resolution_clock::now();                                          // storing ending time
+        double btreeHintedSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Nearby Hinted Find", btreeHintedSearchTime, datasetSize);            // displaying the results i.e. total time taken and average time taken per operation
+
+        cout << "Keys found: " << found << " of " << 4 * datasetSize << endl
+             << endl;
+    }
+
+    void testBufferedBTree(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        // the first half of the ids is loaded up front, the second half is inserted by the mixed workload
+        vector<int> ids = generateShuffledIds(2 * datasetSize);
+        vector<int> loaded, fresh;
+        for (int id : ids)
+        {
+            (id < datasetSize ? loaded : fresh).push_back(id);
+        }
+
+        // mixed workload: 8 inserts of new ids, 1 delete of a loaded id and 1 search in every 10 operations
+        vector<int> kinds(datasetSize); // 0 insert, 1 delete, 2 search
+        vector<int> keys(datasetSize);
+        int inserted = 0, deleted = 0;
+        for (int i = 0; i < datasetSize; i++)
+        {
+            int roll = i % 10;
+            if (roll < 8)
+            {
+                kinds[i] = 0;
+                keys[i] = fresh[inserted++];
+            }
+            else if (roll == 8)
+            {
+                kinds[i] = 1;
+                keys[i] = loaded[deleted++]; // every loaded id is deleted at most once, so none is missing
+            }
+            else
+            {
+                kinds[i] = 2;
+                keys[i] = rand() % (2 * datasetSize);
+            }
+        }
+
+        BTree btree(3);
+        BEpsilonTree betree(BUFFERED_NODE_SIZE);
+
+        // ------------------------ B-Tree ------------------------
+        cout << "------------------- Testing B-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            btree.insert(loaded[i]); // every insert walks down to a leaf
+        }
+        auto end = chrono::high_resolution_clock::now();                               // storing ending time
+        double btreeInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert", btreeInsertTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Mixed Workload Time
+        int btreeFound = 0;                           // counting the hits keeps the compiler from dropping the searches
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            if (kinds[i] == 0)
+            {
+                btree.insert(keys[i]);
+            }
+            else if (kinds[i] == 1)
+            {
+                btree.remove(keys[i]);
+            }
+            else
+            {
+                btreeFound += btree.search(keys[i]) != nullptr;
+            }
+        }
+        end = chrono::high_resolution_clock::now();                                   // storing ending time
+        double btreeMixedTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Mixed", btreeMixedTime, datasetSize);                         // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            btreeFound += btree.search(ids[i]) != nullptr; // searching the data
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double btreeSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Search", btreeSearchTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Keys found: " << btreeFound << endl
+             << endl;
+
+        // ------------------------ B^e-Tree ------------------------
+        cout << "------------------- Testing B^e-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            betree.insert(loaded[i]); // inserts wait in the root buffer and move down in batches
+        }
+        end = chrono::high_resolution_clock::now();                                     // storing ending time
+        double betreeInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Insert", betreeInsertTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Mixed Workload Time
+        int betreeFound = 0;                          // counting the hits keeps the compiler from dropping the searches
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            if (kinds[i] == 0)
+            {
+                betree.insert(keys[i]);
+            }
+            else if (kinds[i] == 1)
+            {
+                betree.remove(keys[i]);
+            }
+            else
+            {
+                betreeFound += betree.search(keys[i]);
+            }
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double betreeMixedTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Mixed", betreeMixedTime, datasetSize);                         // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < datasetSize; i++)
+        {
+            betreeFound += betree.search(ids[i]); // searching the data, buffers are checked on the way down
+        }
+        end = chrono::high_resolution_clock::now();                                     // storing ending time
+        double betreeSearchTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Search", betreeSearchTime, datasetSize);                        // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Keys found: " << betreeFound << endl;
+        cout << "Messages still buffered: " << betree.buffered() << endl
+             << endl;
+    }
+
+    void testExpiry(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+
+        expireTree<BinarySearchTree>("BSTs", data, ids, []()
+                                     { return BinarySearchTree(); });
+        expireTree<AVL>("AVL-Trees", data, ids, []()
+                        { return AVL(); });
+        expireTree<BTree>("B-Trees", data, ids, []()
+                          { return BTree(3); });
+    }
+
+    void testSecondaryIndex(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+
+        // every age in the dataset is id % 100
+        int queryAges[AGE_QUERIES];
+        generateRandomKeys(queryAges, AGE_QUERIES, 100);
+
+        AVL avl;
+        MultiIndex index;
+        cout << "------------------- Secondary Index on Age -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            avl.insert(data.ids[id], data.name(id), data.ages[id]); // only the primary tree
+        }
+        auto end = chrono::high_resolution_clock::now();                             // storing ending time
+        double avlInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("AVL Insert", avlInsertTime, datasetSize);                    // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            index.insert(data.ids[id], data.name(id), data.ages[id]); // primary tree and age index together
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double indexInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Indexed Insert", indexInsertTime, datasetSize);                // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Find By Age Time
+        long long scanned = 0;                        // counting the matches keeps the compiler from dropping the queries
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < AGE_QUERIES; i++)
+        {
+            vector<int> matches;
+            int age = queryAges[i];
+            avl.forEach([&matches, age](AVLNode *node)
+                        {
+                if (node->age == age)
+                {
+                    matches.push_back(node->id);
+                } });
+            scanned += matches.size();
+        }
+        end = chrono::high_resolution_clock::now();                                           // storing ending time
+        double scanFindTime = chrono::duration<double, milli>(end - start).count();           // calculate the total time taken
+        displayResults("Find By Age with Full Scan", scanFindTime, AGE_QUERIES, AGE_QUERIES); // displaying the results i.e. total time taken and average time taken per operation
+
+        long long indexed = 0;
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < AGE_QUERIES; i++)
+        {
+            indexed += index.findByAge(queryAges[i]).size(); // only the matching part of the age index is visited
+        }
+        end = chrono::high_resolution_clock::now();                                        // storing ending time
+        double indexFindTime = chrono::duration<double, milli>(end - start).count();       // calculate the total time taken
+        displayResults("Find By Age with Index", indexFindTime, AGE_QUERIES, AGE_QUERIES); // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Records matched: " << indexed << " (full scan: " << scanned << ")" << endl
+             << endl;
+
+        // Measuring Age Range Time
+        scanned = 0;
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < AGE_QUERIES; i++)
+        {
+            vector<int> matches;
+            int lo = queryAges[i], hi = queryAges[i] + AGE_RANGE_WIDTH - 1;
+            avl.forEach([&matches, lo, hi](AVLNode *node)
+                        {
+                if (node->age >= lo && node->age <= hi)
+                {
+                    matches.push_back(node->id);
+                } });
+            scanned += matches.size();
+        }
+        end = chrono::high_resolution_clock::now();                                          // storing ending time
+        double scanRangeTime = chrono::duration<double, milli>(end - start).count();         // calculate the total time taken
+        displayResults("Age Range with Full Scan", scanRangeTime, AGE_QUERIES, AGE_QUERIES); // displaying the results i.e. total time taken and average time taken per operation
+
+        indexed = 0;
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int i = 0; i < AGE_QUERIES; i++)
+        {
+            indexed += index.ageRange(queryAges[i], queryAges[i] + AGE_RANGE_WIDTH - 1).size();
+        }
+        end = chrono::high_resolution_clock::now();                                       // storing ending time
+        double indexRangeTime = chrono::duration<double, milli>(end - start).count();     // calculate the total time taken
+        displayResults("Age Range with Index", indexRangeTime, AGE_QUERIES, AGE_QUERIES); // displaying the results i.e. total time taken and average time taken per operation
+        cout << "Records matched: " << indexed << " (full scan: " << scanned << ")" << endl
+             << endl;
+
+        // Measuring Deletion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            avl.remove(id); // only the primary tree
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double avlDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("AVL Delete", avlDeleteTime, datasetSize);                    // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            index.remove(id); // the age is looked up in the primary tree, then both indexes are updated
+        }
+        end = chrono::high_resolution_clock::now();                                    // storing ending time
+        double indexDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Indexed Delete", indexDeleteTime, datasetSize);                // displaying the results i.e. total time taken and average time taken per operation
+    }
+
+    void testPersistentAVL(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+
+        AVL avl;
+        PersistentAVL persistent;
+        cout << "------------------- Persistent AVL-Trees -------------------" << endl
+             << endl;
+
+        // Measuring Insertion Time
+        auto start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            avl.insert(data.ids[id], data.name(id), data.ages[id]); // changing the nodes in place
+        }
+        auto end = chrono::high_resolution_clock::now();                             // storing ending time
+        double avlInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Mutable Insert", avlInsertTime, datasetSize);                // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            persistent.insert(data.ids[id], data.name(id), data.ages[id]); // copying the path and publishing a new version
+        }
+        end = chrono::high_resolution_clock::now();                                         // storing ending time
+        double persistentInsertTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Persistent Insert", persistentInsertTime, datasetSize);             // displaying the results i.e. total time taken and average time taken per operation
+
+        // Measuring Search Time with Concurrent Updates
+        // the writer keeps removing and inserting existing ids, so the number of records stays the same
+        shared_mutex lock;
+        int maxReaders = min(MAX_READERS, max(2, threadBudget()));
+        for (int readers = 1; readers <= maxReaders; readers *= 2)
+        {
+            raceReaders(
+                "Locked Mutable Lookups", readers, datasetSize,
+                [&](int reader, int lookups)
+                {
+                    long long found = 0;
+                    unsigned seed = reader + 1;
+                    for (int i = 0; i < lookups; i++)
+                    {
+                        shared_lock<shared_mutex> guard(lock); // readers share the lock, the writer waits for all of them
+                        found += avl.search(nextKey(seed, datasetSize));
+                    }
+                    return found;
+                },
+                [&](long long step)
+                {
+                    int id = ids[step % datasetSize];
+                    unique_lock<shared_mutex> guard(lock); // every reader waits while the tree changes
+                    avl.remove(id);
+                    avl.insert(data.ids[id], data.name(id), data.ages[id]);
+                });
+
+            raceReaders(
+                "Snapshot Persistent Lookups", readers, datasetSize,
+                [&](int reader, int lookups)
+                {
+                    long long found = 0;
+                    unsigned seed = reader + 1;
+                    for (int i = 0; i < lookups; i += SNAPSHOT_LOOKUPS)
+                    {
+                        Snapshot snapshot(persistent, reader); // no lock, the pinned version stays valid until the snapshot ends
+                        for (int j = i; j < min(lookups, i + SNAPSHOT_LOOKUPS); j++)
+                        {
+                            found += snapshot.search(nextKey(seed, datasetSize));
+                        }
+                    }
+                    return found;
+                },
+                [&](long long step)
+                {
+                    int id = ids[step % datasetSize];
+                    persistent.remove(id); // every update publishes a new version without waiting for the readers
+                    persistent.insert(data.ids[id], data.name(id), data.ages[id]);
+                });
+        }
+        cout << "Retired nodes and records not yet freed: " << persistent.retiredCount() << endl
+             << endl;
+
+        // Measuring Deletion Time
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            avl.remove(id); // removing the data
+        }
+        end = chrono::high_resolution_clock::now();                                  // storing ending time
+        double avlDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Mutable Delete", avlDeleteTime, datasetSize);                // displaying the results i.e. total time taken and average time taken per operation
+
+        start = chrono::high_resolution_clock::now(); // storing start time
+        for (int id : ids)
+        {
+            persistent.remove(id); // the unlinked nodes are retired and freed once no reader can reach them
+        }
+        end = chrono::high_resolution_clock::now();                                         // storing ending time
+        double persistentDeleteTime = chrono::duration<double, milli>(end - start).count(); // calculate the total time taken
+        displayResults("Persistent Delete", persistentDeleteTime, datasetSize);             // displaying the results i.e. total time taken and average time taken per operation
+    }
+
+    void testAsyncLookups(int datasetSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        Dataset data(datasetSize);
+        vector<int> ids = generateShuffledIds(datasetSize);
+        vector<int> keys(datasetSize);
+        generateRandomKeys(keys.data(), datasetSize, datasetSize);
+
+        // inserting in random order scatters the nodes over the heap, so a lookup misses the cache on most steps
+        AVL avl;
+        BTree btree(3);
+        for (int id : ids)
+        {
+            insertRecord(avl, data, id);
+            insertRecord(btree, data, id);
+        }
+
+        interleaveTree<AVLNode *>("AVL-Tree", avl, keys);
+        interleaveTree<BTreeNode *>("B-Tree", btree, keys);
+    }
+
+    void testComplexity(int maxSize)
+    {
+        srand(time(0)); // Seed random number generator
+
+        // geometric series of sizes, each twice the previous one, up to the requested dataset size
+        vector<int> sizes;
+        for (long long size = SWEEP_START; size <= maxSize; size *= 2)
+        {
+            sizes.push_back(size);
+        }
+
+        Dataset data(maxSize); // the smaller sizes use a prefix of the same records
+
+        sweepTree<BinarySearchTree>("BSTs", data, sizes, BST_SWEEP_LIMIT, []()
+                                    { return BinarySearchTree(); });
+        sweepTree<AVL>("AVL-Trees", data, sizes, maxSize, []()
+                       { return AVL(); });
+        sweepTree<BTree>("B-Trees", data, sizes, maxSize, []()
+                         { return BTree(3); });
+        sweepTree<ART>("Adaptive Radix Trees", data, sizes, maxSize, []()
+                       { return ART(); });
+    }
+};
+
+int main()
+{
+    PerformanceTester tester;
+
+    int datasetSize;
+    cout << "Enter the number of records to test: ";
+    cin >> datasetSize;
+    cout << endl;
+
+    int choice;
+    cout << "1. Compare BST, AVL, B-Tree and adaptive radix tree operations" << endl;
+    cout << "2. Parallel bulk build of AVL and B-Tree" << endl;
+    cout << "3. Batch insert and erase on AVL" << endl;
+    cout << "4. Rank, select and range count on AVL and B-Tree" << endl;
+    cout << "5. Compact AVL against pointer-based AVL" << endl;
+    cout << "6. String-key B-Tree with prefix compression" << endl;
+    cout << "7. Complexity sweep up to the dataset size" << endl;
+    cout << "8. Sequential appends and nearby lookups with finger hints" << endl;
+    cout << "9. Insert-heavy and mixed workloads on a buffered B^e-Tree" << endl;
+    cout << "10. Expiring contiguous ids with range and bulk erase" << endl;
+    cout << "11. Queries by age with a secondary index against full scans" << endl;
+    cout << "12. Lock-free snapshot readers on a persistent AVL against a locked AVL" << endl;
+    cout << "13. Interleaved coroutine lookups on AVL and B-Tree" << endl;
+    cout << "Select the test to run: ";
+    cin >> choice;
+    cout << endl;
+
+    switch (choice)
+    {
+    case 2:
+        tester.testBulkBuild(datasetSize);
+        break;
+    case 3:
+        tester.testBatchUpdates(datasetSize);
+        break;
+    case 4:
+        tester.testOrderStatistics(datasetSize);
+        break;
+    case 5:
+        tester.testCompactAVL(datasetSize);
+        break;
+    case 6:
+        tester.testStringBTree(datasetSize);
+        break;
+    case 7:
+        tester.testComplexity(datasetSize);
+        break;
+    case 8:
+        tester.testHints(datasetSize);
+        break;
+    case 9:
+        tester.testBufferedBTree(datasetSize);
+        break;
+    case 10:
+        tester.testExpiry(datasetSize);
+        break;
+    case 11:
+        tester.testSecondaryIndex(datasetSize);
+        break;
+    case 12:
+        tester.testPersistentAVL(datasetSize);
+        break;
+    case 13:
+        tester.testAsyncLookups(datasetSize);
+        break;
+    default:
+        tester.testTrees(datasetSize);
+        break;
+    }
 
     return 0;
 }